@@ -0,0 +1,258 @@
+#include "ArenaAllocator.h"
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+
+// Constructor - formats the pool and reserves the arena at its start
+// Throws invalid_argument if the arena does not fit in the pool
+template <class Header>
+BasicArenaAllocator<Header>::BasicArenaAllocator(size_t poolSize, size_t arenaSize,
+    const BackingStore& backing)
+    : Base(poolSize, backing), m_requestedArena(arenaSize ? arenaSize : poolSize / 2),
+    m_arenaStart(nullptr), m_arenaEnd(nullptr), m_cursor(nullptr), m_lastObject(nullptr) {
+
+    if (m_requestedArena > (poolSize & ~(size_t)7) - sizeof(Header)) {
+        throw invalid_argument("Arena size does not fit in the pool.");
+    }
+    carveArena();
+}
+
+// Return the name of the allocation algorithm
+template <class Header>
+const char* BasicArenaAllocator<Header>::getAlgorithmName() const {
+    return sizeof(Header) == sizeof(CompactBlock) ? "Arena (compact)" : "Arena";
+}
+
+
+// Allocate by moving the arena cursor forward
+// Falls back to first fit on the rest of the pool once the arena is full
+// Throws invalid_argument if requested size is zero
+template <class Header>
+void* BasicArenaAllocator<Header>::allocate(size_t size) {
+    if (size == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+
+    // The cursor and the arena end are multiples of 8 apart, so a size
+    // that fits still fits once rounded
+    if (size <= (size_t)(m_arenaEnd - m_cursor)) {
+        char* data = m_cursor;
+        size_t rounded = (size + 7) & ~(size_t)7;
+        m_lastObject = data;
+        m_cursor += rounded;
+        m_usedSize += rounded;
+        if (m_usedSize > m_peakUsage) {
+            m_peakUsage = m_usedSize;
+        }
+        return traceAllocate(size, 0, data);
+    }
+    return Base::allocate(size);
+}
+
+// Allocate memory whose address is a multiple of 'alignment'
+// The padding skipped in the arena is charged as used memory
+// Throws invalid_argument if the size is zero or the alignment is not a
+// power of two
+template <class Header>
+void* BasicArenaAllocator<Header>::allocate(size_t size, size_t alignment) {
+    if (size == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+    if (!isValidAlignment(alignment)) {
+        throw invalid_argument("Alignment must be a power of two.");
+    }
+
+    size_t step = alignment > 8 ? alignment : 8;
+    size_t aligned = ((size_t)m_cursor + step - 1) & ~(step - 1);
+    if (aligned <= (size_t)m_arenaEnd && size <= (size_t)m_arenaEnd - aligned) {
+        char* data = (char*)aligned;
+        char* end = data + ((size + 7) & ~(size_t)7);
+        m_usedSize += end - m_cursor;
+        m_lastObject = data;
+        m_cursor = end;
+        if (m_usedSize > m_peakUsage) {
+            m_peakUsage = m_usedSize;
+        }
+        return traceAllocate(size, alignment, data);
+    }
+
+    // The base class over-allocates through allocate(size); that request is
+    // larger than the one that just failed, so it skips the arena as well
+    return Base::allocate(size, alignment);
+}
+
+
+// Frees a block taken from the rest of the pool
+// Arena objects are left alone - rewind() or releaseAll() frees them
+// Throws std::out_of_range if the pointer is not part of the pool, or lies
+// in the unused part of the arena
+template <class Header>
+void BasicArenaAllocator<Header>::deallocate(void* ptr) {
+    char* data = (char*)ptr;
+    if (data >= m_arenaStart && data < m_arenaEnd) {
+        if (data >= m_cursor) {
+            throw out_of_range("Cannot deallocate: pointer is past the arena cursor.");
+        }
+        traceFree(ptr);
+        return;
+    }
+    Base::deallocate(ptr);
+}
+
+
+// Resize an object
+// The newest arena object grows or shrinks in place while the arena has
+// room; any other arena object is copied (its size is not stored, so up to
+// 'newSize' bytes are copied from it, never past the cursor)
+// Fallback blocks are resized by the block manager
+// Throws invalid_argument if the new size is zero
+// Throws std::out_of_range if the pointer is past the arena cursor
+template <class Header>
+void* BasicArenaAllocator<Header>::reallocate(void* ptr, size_t newSize) {
+    char* data = (char*)ptr;
+    if (!data || data < m_arenaStart || data >= m_arenaEnd) {
+        return Base::reallocate(ptr, newSize);
+    }
+    if (newSize == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+    if (data >= m_cursor) {
+        throw out_of_range("Cannot reallocate: pointer is past the arena cursor.");
+    }
+    TraceScope trace(this);
+
+    // The newest object ends at the cursor, so it can simply move it
+    if (data == m_lastObject && newSize <= (size_t)(m_arenaEnd - data)) {
+        char* end = data + ((newSize + 7) & ~(size_t)7);
+        m_usedSize = m_usedSize + (end - data) - (m_cursor - data);
+        m_cursor = end;
+        if (m_usedSize > m_peakUsage) {
+            m_peakUsage = m_usedSize;
+        }
+        return trace.reallocated(ptr, newSize, ptr);
+    }
+
+    size_t available = m_cursor - data; // The object ends at or before the cursor
+    void* moved = allocate(newSize);
+    if (!moved) {
+        return trace.reallocated(ptr, newSize, nullptr);
+    }
+    memcpy(moved, data, newSize < available ? newSize : available);
+    return trace.reallocated(ptr, newSize, moved);
+}
+
+
+// Allocate each block of a batch with allocate(size)
+template <class Header>
+size_t BasicArenaAllocator<Header>::allocateBatch(const size_t* sizes, size_t count, void** out) {
+    return MemoryManager::allocateBatch(sizes, count, out);
+}
+
+// Free each pointer of a batch with deallocate(ptr)
+template <class Header>
+void BasicArenaAllocator<Header>::deallocateBatch(void* const* ptrs, size_t count) {
+    MemoryManager::deallocateBatch(ptrs, count);
+}
+
+
+// Allocate a movable block from the rest of the pool, never from the arena
+// Throws invalid_argument if size is zero
+template <class Header>
+typename BasicArenaAllocator<Header>::Handle BasicArenaAllocator<Header>::allocateHandle(size_t size) {
+    if (size == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+    if (size > (size_t)PTRDIFF_MAX / 2) {
+        m_failedAllocations++;
+        return Base::kNullHandle;
+    }
+    TraceScope trace(this); // Compaction moves the block, so it is left out
+    return registerHandle(Base::allocate(size + kHandleSlotSize));
+}
+
+
+// Return the current arena cursor
+// The newest object can no longer grow in place: it would grow past the mark
+template <class Header>
+typename BasicArenaAllocator<Header>::Marker BasicArenaAllocator<Header>::mark() {
+    m_lastObject = nullptr;
+    return m_cursor - m_arenaStart;
+}
+
+// Moves the cursor back to 'marker', freeing every arena object allocated
+// after it at once (fallback blocks are not affected)
+// Throws out_of_range if the marker is past the current cursor
+template <class Header>
+void BasicArenaAllocator<Header>::rewind(Marker marker) {
+    if (marker > (size_t)(m_cursor - m_arenaStart)) {
+        throw out_of_range("Cannot rewind: marker is past the arena cursor.");
+    }
+    m_usedSize -= (m_cursor - m_arenaStart) - marker;
+    m_cursor = m_arenaStart + marker;
+    if (m_lastObject >= m_cursor) {
+        m_lastObject = nullptr; // Objects before the marker are not tracked
+    }
+}
+
+
+// Reset the pool with a new size and reserve the arena again
+// Throws logic_error if the pool cannot hold the arena
+template <class Header>
+void BasicArenaAllocator<Header>::reset(size_t poolSize) {
+    if (poolSize < sizeof(Header) || m_requestedArena > (poolSize & ~(size_t)7) - sizeof(Header)) {
+        throw logic_error("Reset failed: pool size too small to hold the arena.");
+    }
+    Base::reset(poolSize);
+    carveArena();
+}
+
+// Free the arena and every fallback block, keeping the peak statistics
+template <class Header>
+void BasicArenaAllocator<Header>::releaseAll() {
+    Base::releaseAll();
+    carveArena();
+}
+
+
+// Return the number of bytes reserved for the arena
+template <class Header>
+size_t BasicArenaAllocator<Header>::getArenaSize() const {
+    return m_arenaEnd - m_arenaStart;
+}
+
+// Return the number of bytes handed out from the arena (padding included)
+template <class Header>
+size_t BasicArenaAllocator<Header>::getArenaUsed() const {
+    return m_cursor - m_arenaStart;
+}
+
+
+// Turns the first block of a freshly formatted pool into the arena
+// Only the arena's header counts as used until objects are bumped into it
+template <class Header>
+void BasicArenaAllocator<Header>::carveArena() {
+    size_t peakBefore = m_peakUsage;
+    m_arenaStart = (char*)placeAllocation(m_memoryPool, Base::roundRequest(m_requestedArena));
+    m_arenaEnd = m_arenaStart + m_memoryPool->getSize();
+    MM_HARDEN(m_arenaEnd = m_arenaStart + m_memoryPool->getRequestSize()); // Not the red zone
+    m_cursor = m_arenaStart;
+    m_lastObject = nullptr;
+
+    m_usedSize -= m_memoryPool->getSize();
+    m_peakUsage = m_usedSize > peakBefore ? m_usedSize : peakBefore;
+}
+
+
+// Print the arena usage followed by the block list
+template <class Header>
+void BasicArenaAllocator<Header>::printBlocks(ostream& os) const {
+    os << "Arena: used=" << getArenaUsed() << " of " << getArenaSize() << "\n";
+    Base::printBlocks(os);
+}
+
+
+// Header layouts available to the allocator
+template class BasicArenaAllocator<Block>;
+template class BasicArenaAllocator<CompactBlock>;
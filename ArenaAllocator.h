@@ -0,0 +1,96 @@
+#ifndef ARENA_ALLOCATOR_H
+#define ARENA_ALLOCATOR_H
+
+#include "FirstFitAllocator.h"
+
+// Linear (bump) allocator for request-scoped memory.
+// An arena is reserved at the start of the pool; allocations inside it only
+// move a cursor forward and carry no block header. mark() saves the cursor
+// and rewind() drops everything allocated after the mark at once. When the
+// arena is exhausted, requests fall back to first fit on the rest of the pool.
+// Arena objects are not freed one by one: deallocate ignores them and their
+// memory comes back with rewind(), releaseAll() or reset().
+template <class Header>
+class BasicArenaAllocator : public BasicFirstFitAllocator<Header> {
+
+    protected:
+        typedef BasicFirstFitAllocator<Header> Base;
+        using Base::m_memoryPool;
+        using Base::m_usedSize;
+        using Base::m_peakUsage;
+        using Base::m_failedAllocations;
+        using Base::m_totalSize;
+        using Base::placeAllocation;
+        using Base::isValidAlignment;
+        using Base::registerHandle;
+        using Base::kHandleSlotSize;
+        using Base::traceAllocate;
+        using Base::traceFree;
+        typedef typename Base::TraceScope TraceScope;
+
+        // Print the arena usage and the block list (used by operator<<)
+        void printBlocks(std::ostream& os) const;
+
+    public:
+        // Position of the arena cursor, returned by mark()
+        typedef size_t Marker;
+
+        // Constructor - reserves 'arenaSize' bytes of the pool for the arena
+        // (0 = half of the pool)
+        // Throws invalid_argument if the arena does not fit in the pool
+        BasicArenaAllocator(size_t poolSize, size_t arenaSize = 0,
+            const BackingStore& backing = BackingStore());
+
+        // Bump-allocate from the arena, or fall back to first fit
+        void* allocate(size_t size);
+        void* allocate(size_t size, size_t alignment);
+
+        // Free a fallback block (arena objects are freed by rewind)
+        void deallocate(void* ptr);
+
+        // Resize the newest arena object in place by moving the cursor;
+        // other arena objects are copied to a new object (the old one stays
+        // until rewind) and fallback blocks are resized by first fit
+        void* reallocate(void* ptr, size_t newSize);
+
+        // Batches go through allocate/deallocate one block at a time, so
+        // arena objects are bumped and never carved with block headers
+        size_t allocateBatch(const size_t* sizes, size_t count, void** out);
+        using MemoryManager::allocateBatch;
+        void deallocateBatch(void* const* ptrs, size_t count);
+
+        // Handle blocks always come from first fit: arena objects have no
+        // header, so the compactor could not move them
+        typedef typename Base::Handle Handle;
+        Handle allocateHandle(size_t size);
+
+        Marker mark();                     // Save the arena cursor
+        void rewind(Marker marker);        // Free everything allocated after 'marker'
+
+        void reset(size_t poolSize);       // Reset the pool and the arena
+        void releaseAll();                 // Free the arena and every fallback block
+
+        size_t getArenaSize() const;       // Bytes reserved for the arena
+        size_t getArenaUsed() const;       // Bytes handed out from the arena
+
+        // Return the name of the allocation algorithm
+        const char* getAlgorithmName() const;
+
+    private:
+        void carveArena();                 // Reserve the arena block in a fresh pool
+
+        size_t m_requestedArena;  // Arena size asked for in the constructor
+        char* m_arenaStart;       // First byte of the arena
+        char* m_arenaEnd;         // End of the arena
+        char* m_cursor;           // Next free byte of the arena
+        char* m_lastObject;       // Newest arena object (nullptr = none)
+};
+
+// Allocator with the default 16-byte block header
+typedef BasicArenaAllocator<Block> ArenaAllocator;
+
+// Allocator with the 8-byte block header (pools under 4 GiB)
+typedef BasicArenaAllocator<CompactBlock> CompactArenaAllocator;
+
+
+#endif // ARENA_ALLOCATOR_H
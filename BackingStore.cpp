@@ -0,0 +1,226 @@
+#include "BackingStore.h"
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <vector>
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+// Constructor
+// Throws invalid_argument if options are given for heap memory or the
+// NUMA node is below -1
+BackingStore::BackingStore(Source source, int options, int numaNode)
+    : m_source(source), m_options(options), m_numaNode(numaNode) {
+    if (source == kHeap && (options != 0 || numaNode != -1)) {
+        throw invalid_argument("Page and NUMA options need mapped memory.");
+    }
+    if (numaNode < -1) {
+        throw invalid_argument("NUMA node must be -1 (any) or a node number.");
+    }
+}
+
+
+#if defined(__linux__)
+
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+
+// Bind a mapping to one NUMA node (the system call behind mbind(2), so no
+// libnuma is needed)
+// Returns false if the node does not exist; a kernel without NUMA support
+// has a single node, so there is nothing to bind
+static bool bindToNode(void* memory, size_t length, int node) {
+    const size_t bitsPerWord = sizeof(unsigned long) * 8;
+    vector<unsigned long> nodeMask(node / bitsPerWord + 1, 0);
+    nodeMask[node / bitsPerWord] = 1UL << (node % bitsPerWord);
+
+    long result = syscall(SYS_mbind, memory, length, MPOL_BIND, nodeMask.data(),
+        nodeMask.size() * bitsPerWord + 1, 0);
+    return result == 0 || errno == ENOSYS;
+}
+
+#endif
+
+
+// Get memory for 'size' bytes of pool
+// Mapped memory is taken as:
+//  1. MAP_HUGETLB pages when huge pages are asked for and reserved
+//  2. otherwise normal pages, aligned to 2 MiB and marked MADV_HUGEPAGE so
+//     the kernel can still use transparent huge pages
+// Binding happens before prefaulting, so the first touch lands on the node
+// Heap memory is over-allocated to start on a kHeapAlignment boundary; the
+// pointer new[] returned is kept in the word right in front of it
+// Throws bad_alloc if no memory is available
+char* BackingStore::acquire(size_t size) const {
+#if defined(__linux__)
+    if (m_source == kMappedMemory) {
+        size_t length = mappedLength(size);
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        bool populate = (m_options & kPrefault) != 0;
+        if (populate && m_numaNode < 0) {
+            flags |= MAP_POPULATE; // The kernel prefaults during the mmap
+            populate = false;
+        }
+
+        char* memory = (char*)MAP_FAILED;
+        if (m_options & kHugePages) {
+            memory = (char*)mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                flags | MAP_HUGETLB, -1, 0);
+        }
+        if (memory == (char*)MAP_FAILED) {
+            // Over-map so the pool can start on a huge page boundary
+            size_t slack = (m_options & kHugePages) ? kHugePageSize : 0;
+            char* raw = (char*)mmap(nullptr, length + slack, PROT_READ | PROT_WRITE,
+                flags, -1, 0);
+            if (raw == (char*)MAP_FAILED) {
+                throw bad_alloc();
+            }
+            memory = raw;
+            if (slack) {
+                memory = (char*)(((size_t)raw + slack - 1) & ~(slack - 1));
+                if (memory > raw) {
+                    munmap(raw, memory - raw);
+                }
+                if (raw + slack > memory) {
+                    munmap(memory + length, raw + slack - memory);
+                }
+                madvise(memory, length, MADV_HUGEPAGE);
+            }
+        }
+
+        if (m_numaNode >= 0 && !bindToNode(memory, length, m_numaNode)) {
+            munmap(memory, length);
+            throw invalid_argument("Cannot bind pool memory to the requested NUMA node.");
+        }
+
+        // Fault the pages in on the bound node
+        if (populate) {
+            long pageSize = sysconf(_SC_PAGESIZE);
+            for (size_t offset = 0; offset < length; offset += pageSize) {
+                memory[offset] = 0;
+            }
+        }
+        return memory;
+    }
+#endif
+    if (size > SIZE_MAX - kHeapAlignment) {
+        throw bad_alloc();
+    }
+    char* raw = new char[size + kHeapAlignment];
+    char* memory = (char*)(((size_t)raw + sizeof(char*) + kHeapAlignment - 1) &
+        ~(kHeapAlignment - 1));
+    ((char**)memory)[-1] = raw;
+    return memory;
+}
+
+
+// Give back memory returned by acquire(size)
+void BackingStore::release(char* memory, size_t size) const {
+    if (!memory) {
+        return;
+    }
+#if defined(__linux__)
+    if (m_source == kMappedMemory) {
+        munmap(memory, mappedLength(size));
+        return;
+    }
+#endif
+    delete[] ((char**)memory)[-1];
+}
+
+
+// Return the pages lying completely inside [start, start + length) to the
+// system with MADV_DONTNEED, so the resident size drops right away
+// (MADV_FREE would leave that to the kernel under memory pressure)
+// Works on heap memory too; on other systems nothing is released
+size_t BackingStore::purge(char* start, size_t length) const {
+#if defined(__linux__)
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t first = ((size_t)start + pageSize - 1) & ~(pageSize - 1);
+    size_t last = ((size_t)start + length) & ~(pageSize - 1);
+    if (last <= first) {
+        return 0;
+    }
+    if (madvise((void*)first, last - first, MADV_DONTNEED) == 0) {
+        return last - first;
+    }
+#else
+    (void)start;
+    (void)length;
+#endif
+    return 0;
+}
+
+
+// Count the resident bytes of [start, start + length) with mincore
+// Pages shared with memory outside the range only count for their overlap
+// On other systems the whole range is taken as resident
+size_t BackingStore::residentBytes(const char* start, size_t length) const {
+#if defined(__linux__)
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t first = (size_t)start & ~(pageSize - 1);
+    size_t end = (size_t)start + length;
+    vector<unsigned char> pages((end - first + pageSize - 1) / pageSize);
+    if (length == 0 || mincore((void*)first, end - first, pages.data()) != 0) {
+        return length;
+    }
+
+    size_t resident = 0;
+    for (size_t i = 0; i < pages.size(); i++) {
+        if (pages[i] & 1) {
+            size_t pageStart = first + i * pageSize;
+            size_t from = pageStart > (size_t)start ? pageStart : (size_t)start;
+            size_t to = pageStart + pageSize < end ? pageStart + pageSize : end;
+            resident += to - from;
+        }
+    }
+    return resident;
+#else
+    (void)start;
+    return length;
+#endif
+}
+
+
+// Round a mapping up to whole (huge) pages, as the kernel does
+size_t BackingStore::mappedLength(size_t size) const {
+    size_t pageSize = kHugePageSize;
+#if defined(__linux__)
+    if (!(m_options & kHugePages)) {
+        pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return (size + pageSize - 1) & ~(pageSize - 1);
+}
+
+
+// Return where the memory comes from
+BackingStore::Source BackingStore::getSource() const {
+    return m_source;
+}
+
+// Return the kHugePages / kPrefault flags
+int BackingStore::getOptions() const {
+    return m_options;
+}
+
+// Return the NUMA node the memory is bound to (-1 = any)
+int BackingStore::getNumaNode() const {
+    return m_numaNode;
+}
+
+// Return a printable description of the memory source
+const char* BackingStore::getName() const {
+    if (m_source == kHeap) {
+        return "heap";
+    }
+    return (m_options & kHugePages) ? "mmap (huge pages)" : "mmap";
+}
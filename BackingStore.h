@@ -0,0 +1,63 @@
+#ifndef BACKING_STORE_H
+#define BACKING_STORE_H
+
+#include <cstddef>
+
+// Source of the raw memory behind a pool.
+// The default is the heap (new[]), as before, over-allocated so the pool
+// starts on a page boundary like mapped memory does. Mapped memory is taken with
+// an anonymous mmap, can use huge pages (MAP_HUGETLB, or transparent huge
+// pages through madvise when none are reserved), can be prefaulted and can
+// be bound to one NUMA node. On systems without mmap, mapped memory falls
+// back to the heap.
+class BackingStore {
+
+    public:
+        enum Source {
+            kHeap,             // new[] / delete[]
+            kMappedMemory      // Anonymous mmap / munmap
+        };
+
+        // Options for mapped memory (combine with |)
+        static const int kHugePages = 1;   // Back the pool with 2 MiB pages
+        static const int kPrefault = 2;    // Touch every page up front
+
+        static const size_t kHugePageSize = (size_t)2 << 20;
+        static const size_t kHeapAlignment = 4096; // Start of a heap pool
+
+        // Constructor - 'numaNode' binds mapped memory to a node (-1 = any)
+        // Throws invalid_argument if options are given for heap memory or
+        // the node number is invalid
+        BackingStore(Source source = kHeap, int options = 0, int numaNode = -1);
+
+        // Get memory for 'size' bytes of pool
+        // Throws bad_alloc if the memory is not available, invalid_argument
+        // if it cannot be bound to the requested NUMA node
+        char* acquire(size_t size) const;
+
+        // Give back memory returned by acquire(size)
+        void release(char* memory, size_t size) const;
+
+        // Return the whole pages inside a range to the system while keeping
+        // the addresses valid (they read as zeros once touched again)
+        // Returns the number of bytes released
+        size_t purge(char* start, size_t length) const;
+
+        // Count the bytes of a range that are backed by physical memory
+        size_t residentBytes(const char* start, size_t length) const;
+
+        Source getSource() const;     // Heap or mapped memory
+        int getOptions() const;       // kHugePages / kPrefault flags
+        int getNumaNode() const;      // Bound node (-1 = any)
+        const char* getName() const;  // Printable description
+
+    private:
+        size_t mappedLength(size_t size) const;   // Size rounded to whole pages
+
+        Source m_source;
+        int m_options;
+        int m_numaNode;
+};
+
+
+#endif // BACKING_STORE_H
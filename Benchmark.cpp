@@ -0,0 +1,242 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <stdexcept>
+
+using namespace std;
+
+
+// Constructor
+// Throws invalid_argument if iterations or rounds is not positive, or
+// warmup is negative
+Benchmark::Benchmark(int iterations, int rounds, int warmup, unsigned seed)
+    : m_iterations(iterations), m_rounds(rounds), m_warmup(warmup), m_seed(seed) {
+    if (iterations <= 0 || rounds <= 0) {
+        throw invalid_argument("Benchmark needs a positive number of iterations and rounds.");
+    }
+    if (warmup < 0) {
+        throw invalid_argument("Warm-up rounds cannot be negative.");
+    }
+}
+
+// Return the seed of every workload
+unsigned Benchmark::getSeed() const {
+    return m_seed;
+}
+
+// Return the names of the scenarios (the simulator's, see Workload)
+const vector<string>& Benchmark::getScenarios() {
+    return Workload::getScenarios();
+}
+
+
+// Runs the warm-up passes, then times the calls of the timed passes in
+// runs of up to kTimedCalls calls of the same kind (a batch call is one
+// run); every call of a run is charged the run's average
+// The pool is reset before each pass, so every pass starts from the same
+// state
+// Throws invalid_argument if the scenario is unknown
+Benchmark::Result Benchmark::run(MemoryManager* allocator, const string& scenario) {
+    typedef chrono::steady_clock Clock;
+    mt19937 random(m_seed);
+    Workload workload(scenario, m_iterations, random);
+    const vector<Workload::Operation>& ops = workload.getOperations();
+
+    Result result;
+    result.algorithm = allocator->getAlgorithmName();
+    result.scenario = scenario;
+    result.poolSize = allocator->getTotalMemory();
+    result.seed = m_seed;
+    result.failedAllocations = 0;
+    result.peakUsage = 0;
+
+    vector<double> allocateTimes;
+    vector<double> deallocateTimes;
+    allocateTimes.reserve(ops.size() * m_rounds);
+    deallocateTimes.reserve(ops.size() * m_rounds);
+    vector<void*> pointers(workload.getSlotCount());
+    vector<size_t> sizes;
+    vector<void*> batch;
+
+    for (int pass = 0; pass < m_warmup + m_rounds; pass++) {
+        bool timed = pass >= m_warmup;
+        allocator->reset(result.poolSize);
+        fill(pointers.begin(), pointers.end(), nullptr);
+
+        for (size_t i = 0; i < ops.size(); ) {
+            // The run: a batch call, or single calls of the same kind
+            bool allocating = ops[i].size != 0;
+            size_t end = workload.getCallEnd(i);
+            bool batched = end - i > 1;
+            while (!batched && end < ops.size() && end - i < kTimedCalls &&
+                !ops[end].batched && (ops[end].size != 0) == allocating) {
+                end++;
+            }
+
+            // Arguments are gathered before the clock starts; frees of
+            // blocks that could not be allocated are skipped
+            size_t calls = allocating ? end - i : 0;
+            sizes.clear();
+            batch.clear();
+            for (size_t k = i; k < end; k++) {
+                sizes.push_back(ops[k].size);
+                batch.push_back(allocating ? nullptr : pointers[ops[k].slot]);
+                calls += !allocating && batch.back() != nullptr;
+            }
+
+            Clock::time_point start = Clock::now();
+            if (batched && allocating) {
+                allocator->allocateBatch(sizes.data(), batch.size(), batch.data());
+            }
+            else if (batched) {
+                allocator->deallocateBatch(batch.data(), batch.size());
+            }
+            else if (allocating) {
+                for (size_t k = i; k < end; k++) {
+                    pointers[ops[k].slot] = allocator->allocate(ops[k].size);
+                }
+            }
+            else {
+                for (size_t k = i; k < end; k++) {
+                    if (pointers[ops[k].slot]) {
+                        allocator->deallocate(pointers[ops[k].slot]);
+                    }
+                }
+            }
+            Clock::time_point stop = Clock::now();
+
+            for (size_t k = i; k < end; k++) {
+                void*& pointer = pointers[ops[k].slot];
+                if (allocating) {
+                    if (batched) {
+                        pointer = batch[k - i];
+                    }
+                    if (timed && !pointer) {
+                        result.failedAllocations++;
+                    }
+                }
+                else {
+                    pointer = nullptr;
+                }
+            }
+            if (timed && calls > 0) {
+                double perCall = chrono::duration<double, nano>(stop - start).count() / calls;
+                vector<double>& times = allocating ? allocateTimes : deallocateTimes;
+                times.insert(times.end(), calls, perCall);
+            }
+            i = end;
+        }
+
+        if (timed && allocator->getPeakUsage() > result.peakUsage) {
+            result.peakUsage = allocator->getPeakUsage();
+        }
+    }
+    allocator->reset(result.poolSize);
+
+    result.allocate = summarize(allocateTimes);
+    result.deallocate = summarize(deallocateTimes);
+    return result;
+}
+
+// Runs every scenario on the allocator
+vector<Benchmark::Result> Benchmark::runAll(MemoryManager* allocator) {
+    vector<Result> results;
+    for (size_t i = 0; i < getScenarios().size(); i++) {
+        results.push_back(run(allocator, getScenarios()[i]));
+    }
+    return results;
+}
+
+
+// Returns the nearest-rank percentile of sorted latencies
+static double percentile(const vector<double>& sorted, double fraction) {
+    size_t rank = (size_t)ceil(fraction * sorted.size());
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+// Returns the call count, the rate and the percentiles of the latencies
+Benchmark::Timing Benchmark::summarize(vector<double>& latencies) {
+    Timing timing = { latencies.size(), 0.0, 0.0, 0.0, 0.0 };
+    if (latencies.empty()) {
+        return timing;
+    }
+
+    double total = 0;
+    for (size_t i = 0; i < latencies.size(); i++) {
+        total += latencies[i];
+    }
+    timing.callsPerSecond = total > 0 ? latencies.size() / (total * 1e-9) : 0.0;
+
+    sort(latencies.begin(), latencies.end());
+    timing.p50 = percentile(latencies, 0.50);
+    timing.p99 = percentile(latencies, 0.99);
+    timing.p999 = percentile(latencies, 0.999);
+    return timing;
+}
+
+
+// Print the results as an aligned table (rates in millions of calls per
+// second, latencies in nanoseconds)
+void Benchmark::printTable(ostream& os, const vector<Result>& results) {
+    os << left << setw(22) << "Algorithm" << setw(30) << "Scenario" << right
+        << setw(10) << "alloc M/s" << setw(8) << "p50" << setw(8) << "p99" << setw(9) << "p999"
+        << setw(10) << "free M/s" << setw(8) << "p50" << setw(8) << "p99" << setw(9) << "p999"
+        << setw(8) << "failed" << "\n";
+
+    os << fixed << setprecision(0);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        os << left << setw(22) << r.algorithm << setw(30) << r.scenario << right
+            << setprecision(2) << setw(10) << r.allocate.callsPerSecond / 1e6 << setprecision(0)
+            << setw(8) << r.allocate.p50 << setw(8) << r.allocate.p99 << setw(9) << r.allocate.p999
+            << setprecision(2) << setw(10) << r.deallocate.callsPerSecond / 1e6 << setprecision(0)
+            << setw(8) << r.deallocate.p50 << setw(8) << r.deallocate.p99 << setw(9) << r.deallocate.p999
+            << setw(8) << r.failedAllocations << "\n";
+    }
+    os.unsetf(ios::floatfield);
+    os << setprecision(6);
+}
+
+// Write one CSV line per result, with a header line
+void Benchmark::writeCsv(ostream& os, const vector<Result>& results) {
+    os << "algorithm,scenario,pool_size,seed,"
+        "alloc_calls,alloc_per_sec,alloc_p50_ns,alloc_p99_ns,alloc_p999_ns,"
+        "free_calls,free_per_sec,free_p50_ns,free_p99_ns,free_p999_ns,"
+        "failed_allocations,peak_usage\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        os << "\"" << r.algorithm << "\",\"" << r.scenario << "\"," << r.poolSize << "," << r.seed << ","
+            << r.allocate.calls << "," << r.allocate.callsPerSecond << "," << r.allocate.p50 << ","
+            << r.allocate.p99 << "," << r.allocate.p999 << ","
+            << r.deallocate.calls << "," << r.deallocate.callsPerSecond << "," << r.deallocate.p50 << ","
+            << r.deallocate.p99 << "," << r.deallocate.p999 << ","
+            << r.failedAllocations << "," << r.peakUsage << "\n";
+    }
+}
+
+// Write the results as a JSON array of objects
+// Algorithm and scenario names never hold quotes or control characters
+void Benchmark::writeJson(ostream& os, const vector<Result>& results) {
+    os << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        const Timing* timings[] = { &r.allocate, &r.deallocate };
+        const char* names[] = { "allocate", "deallocate" };
+
+        os << "  {\"algorithm\": \"" << r.algorithm << "\", \"scenario\": \"" << r.scenario
+            << "\", \"pool_size\": " << r.poolSize << ", \"seed\": " << r.seed;
+        for (int t = 0; t < 2; t++) {
+            os << ", \"" << names[t] << "\": {\"calls\": " << timings[t]->calls
+                << ", \"per_sec\": " << timings[t]->callsPerSecond
+                << ", \"p50_ns\": " << timings[t]->p50 << ", \"p99_ns\": " << timings[t]->p99
+                << ", \"p999_ns\": " << timings[t]->p999 << "}";
+        }
+        os << ", \"failed_allocations\": " << r.failedAllocations
+            << ", \"peak_usage\": " << r.peakUsage << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "]\n";
+}
@@ -0,0 +1,128 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "MemoryManager.h"
+#include "Workload.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Timed, reproducible runs of the allocation scenarios.
+// The workloads are the simulator's (see Workload), built from the seed
+// before anything is timed. After the warm-up passes, the calls of the
+// timed passes are timed in runs of up to kTimedCalls calls of the same
+// kind, so the clock is not read around every call; a batch call is one
+// run. Each call is charged the average of its run.
+class Benchmark {
+
+    public:
+        static const unsigned kDefaultSeed = 12345;
+
+        // Latency summary of one kind of call
+        struct Timing {
+            size_t calls;          // Timed calls
+            double callsPerSecond; // Calls per second spent inside them
+            double p50;            // Latency percentiles in nanoseconds, over
+                                   // the per-call averages of the runs
+            double p99;
+            double p999;
+        };
+
+        // Outcome of one scenario on one allocator
+        struct Result {
+            std::string algorithm;
+            std::string scenario;
+            size_t poolSize;
+            unsigned seed;
+            Timing allocate;
+            Timing deallocate;
+            size_t failedAllocations; // Over all timed passes
+            size_t peakUsage;         // Highest peak of a timed pass
+        };
+
+        // Constructor - scenarios of 'iterations' steps, as in the
+        // simulator, 'rounds' timed passes after 'warmup' untimed ones
+        // Throws invalid_argument if iterations or rounds is not positive,
+        // or warmup is negative
+        Benchmark(int iterations = 10000, int rounds = 5, int warmup = 1,
+            unsigned seed = kDefaultSeed);
+
+        // Names of the scenarios, in the order runAll() uses
+        static const std::vector<std::string>& getScenarios();
+
+        // Run one scenario (the pool is reset before every pass)
+        // Throws invalid_argument if the scenario is unknown
+        Result run(MemoryManager* allocator, const std::string& scenario);
+        std::vector<Result> runAll(MemoryManager* allocator); // Every scenario
+
+        // Time the inner allocation loop: 'iterations' steps that each free
+        // the oldest of kRingSlots live blocks and allocate a new one, made
+        // through the static type 'Allocator' - MemoryManager gives virtual
+        // calls, a PoolAllocator direct calls with the search inlined
+        // Returns nanoseconds per step (the fastest of the timed passes)
+        template <class Allocator>
+        double timeInnerLoop(Allocator& allocator) const;
+
+        // Output of a set of results
+        static void printTable(std::ostream& os, const std::vector<Result>& results);
+        static void writeCsv(std::ostream& os, const std::vector<Result>& results);
+        static void writeJson(std::ostream& os, const std::vector<Result>& results);
+
+        unsigned getSeed() const;
+
+    private:
+        // Sorts the latencies and summarizes them
+        static Timing summarize(std::vector<double>& latencies);
+
+        static const size_t kRingSlots = 64; // Live blocks of the inner loop
+        static const size_t kTimedCalls = 16; // Longest run between clock reads
+
+        int m_iterations;
+        int m_rounds;
+        int m_warmup;
+        unsigned m_seed;
+};
+
+
+// The sizes are drawn before the timing; the ring is filled and emptied
+// outside of it, so only the steady state is measured
+template <class Allocator>
+double Benchmark::timeInnerLoop(Allocator& allocator) const {
+    std::vector<size_t> sizes(m_iterations);
+    std::mt19937 random(m_seed);
+    for (size_t i = 0; i < sizes.size(); i++) {
+        sizes[i] = 16 + random() % 241;   // 16 to 256 bytes
+    }
+
+    double best = 0;
+    void* ring[kRingSlots];
+    for (int pass = 0; pass < m_warmup + m_rounds; pass++) {
+        allocator.reset(allocator.getTotalMemory());
+        for (size_t i = 0; i < kRingSlots; i++) {
+            ring[i] = allocator.allocate(sizes[i % sizes.size()]);
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < sizes.size(); i++) {
+            void*& slot = ring[i % kRingSlots];
+            allocator.deallocate(slot);
+            slot = allocator.allocate(sizes[i]);
+        }
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        for (size_t i = 0; i < kRingSlots; i++) {
+            allocator.deallocate(ring[i]);
+        }
+        double perStep = seconds * 1e9 / sizes.size();
+        if (pass >= m_warmup && (best == 0 || perStep < best)) {
+            best = perStep;
+        }
+    }
+    return best;
+}
+
+
+#endif // BENCHMARK_H
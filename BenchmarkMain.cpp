@@ -0,0 +1,145 @@
+#include "Benchmark.h"
+#include "FirstFitAllocator.h"
+#include "BestFitAllocator.h"
+#include "WorstFitAllocator.h"
+#include "NextFitAllocator.h"
+#include "SlabAllocator.h"
+#include "BuddyAllocator.h"
+#include "ArenaAllocator.h"
+#include "PoolAllocator.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+
+// Print the command line options
+static void printUsage(const char* program) {
+    cout << "Usage: " << program << " [options]\n"
+        << "  --iterations N   steps of each scenario (default 10000)\n"
+        << "  --rounds N       timed passes (default 5)\n"
+        << "  --warmup N       untimed passes before them (default 1)\n"
+        << "  --seed N         workload seed (default " << Benchmark::kDefaultSeed << ")\n"
+        << "  --pool BYTES     pool size of every allocator (default 1048576)\n"
+        << "  --csv FILE       write the results as CSV ('-' = standard output)\n"
+        << "  --json FILE      write the results as JSON ('-' = standard output)\n";
+}
+
+// Print the inner-loop time of one strategy through the virtual interface
+// (the classic allocator behind a MemoryManager reference) and through the
+// compile-time PoolAllocator
+template <class Fit, class Classic>
+static void compareInnerLoop(const Benchmark& benchmark, size_t poolSize) {
+    Classic classic(poolSize);
+    PoolAllocator<Fit> pool(poolSize);
+    MemoryManager& virtualCalls = classic;
+    double virtualTime = benchmark.timeInnerLoop(virtualCalls);
+    double directTime = benchmark.timeInnerLoop(pool);
+    cout << left << setw(22) << pool.getAlgorithmName() << right << fixed << setprecision(1)
+        << setw(12) << virtualTime << setw(12) << directTime
+        << setw(10) << (directTime > 0 ? virtualTime / directTime : 0) << "x\n";
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+}
+
+// Write the results to a file, or to standard output for "-"
+// Returns false if the file cannot be opened
+static bool writeResults(const char* path, const vector<Benchmark::Result>& results,
+    void (*write)(ostream&, const vector<Benchmark::Result>&)) {
+    if (strcmp(path, "-") == 0) {
+        write(cout, results);
+        return true;
+    }
+    ofstream file(path);
+    if (!file) {
+        cerr << "Cannot open " << path << " for writing." << endl;
+        return false;
+    }
+    write(file, results);
+    return true;
+}
+
+
+// Runs every scenario on every allocator and reports the timings
+int main(int argc, char* argv[]) {
+    int iterations = 10000;
+    int rounds = 5;
+    int warmup = 1;
+    unsigned seed = Benchmark::kDefaultSeed;
+    size_t poolSize = (size_t)1 << 20;
+    const char* csvPath = nullptr;
+    const char* jsonPath = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--iterations") == 0) iterations = atoi(value);
+        else if (strcmp(argv[i], "--rounds") == 0) rounds = atoi(value);
+        else if (strcmp(argv[i], "--warmup") == 0) warmup = atoi(value);
+        else if (strcmp(argv[i], "--seed") == 0) seed = (unsigned)strtoul(value, nullptr, 10);
+        else if (strcmp(argv[i], "--pool") == 0) poolSize = (size_t)strtoull(value, nullptr, 10);
+        else if (strcmp(argv[i], "--csv") == 0) csvPath = value;
+        else if (strcmp(argv[i], "--json") == 0) jsonPath = value;
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    try {
+        Benchmark benchmark(iterations, rounds, warmup, seed);
+
+        FirstFitAllocator firstFit(poolSize);
+        CompactFirstFitAllocator compactFirstFit(poolSize);
+        BestFitAllocator bestFit(poolSize);
+        WorstFitAllocator worstFit(poolSize);
+        NextFitAllocator nextFit(poolSize);
+        SlabAllocator slab(poolSize);
+        BuddyAllocator buddy(poolSize);
+        ArenaAllocator arena(poolSize);
+        MemoryManager* allocators[] = { &firstFit, &compactFirstFit, &bestFit, &worstFit,
+                                        &nextFit, &slab, &buddy, &arena };
+
+        vector<Benchmark::Result> results;
+        for (size_t i = 0; i < sizeof(allocators) / sizeof(allocators[0]); i++) {
+            vector<Benchmark::Result> own = benchmark.runAll(allocators[i]);
+            results.insert(results.end(), own.begin(), own.end());
+        }
+
+        // The table goes to standard output unless a result file does
+        bool toStdout = (csvPath && strcmp(csvPath, "-") == 0) ||
+            (jsonPath && strcmp(jsonPath, "-") == 0);
+        if (!toStdout) {
+            cout << "Seed " << seed << ", " << iterations << " iterations x " << rounds
+                << " rounds (" << warmup << " warm-up), pool " << poolSize << " bytes\n\n";
+            Benchmark::printTable(cout, results);
+
+            cout << "\nInner loop, ns per free + allocate\n"
+                << left << setw(22) << "Algorithm" << right << setw(12) << "virtual"
+                << setw(12) << "template" << setw(11) << "speedup" << "\n";
+            compareInnerLoop<FirstFit, FirstFitAllocator>(benchmark, poolSize);
+            compareInnerLoop<BestFit, BestFitAllocator>(benchmark, poolSize);
+            compareInnerLoop<WorstFit, WorstFitAllocator>(benchmark, poolSize);
+            compareInnerLoop<NextFit, NextFitAllocator>(benchmark, poolSize);
+        }
+        if (csvPath && !writeResults(csvPath, results, Benchmark::writeCsv)) {
+            return 1;
+        }
+        if (jsonPath && !writeResults(jsonPath, results, Benchmark::writeJson)) {
+            return 1;
+        }
+    }
+    catch (const std::exception& e) {
+        cerr << "Benchmark failed: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
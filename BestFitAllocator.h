@@ -1,24 +1,33 @@
 #ifndef BEST_FIT_ALLOCATOR_H
 #define BEST_FIT_ALLOCATOR_H
 
-#include "MemoryManager.h"
+#include "FitPolicy.h"
 
-class BestFitAllocator : public MemoryManager {
+template <class Header>
+class BasicBestFitAllocator : public BasicMemoryManager<Header> {
+
+    protected:
+        typedef BasicMemoryManager<Header> Base;
 
     public:
         // Constructor: initializes memory pool with given size
-        BestFitAllocator(int poolSize);
+        BasicBestFitAllocator(size_t poolSize,
+            const BackingStore& backing = BackingStore());
 
         // Allocates memory block of requested size using Best Fit algorithm
-        void* allocate(int size);
+        // (the BestFit policy, through the virtual interface)
+        void* allocate(size_t size);
+        using Base::allocate;          // Aligned overload
 
         // Returns the name of this allocation algorithm
         const char* getAlgorithmName() const;
-
-    private:
-        // Finds the best fitting free block for the requested size
-        Block* findBestFit(int size);
 };
 
+// Allocator with the default 16-byte block header
+typedef BasicBestFitAllocator<Block> BestFitAllocator;
+
+// Allocator with the 8-byte block header (pools under 4 GiB)
+typedef BasicBestFitAllocator<CompactBlock> CompactBestFitAllocator;
+
 
 #endif // BEST_FIT_ALLOCATOR_H
@@ -1,66 +1,53 @@
 #include "Block.h"
 #include <iostream>
 #include <stdexcept> // 
+#include <cstdint>
 using namespace std;
 
-// Constructor
-Block::Block(int size)
-    : m_next(nullptr), m_isFree(true) {
-    if (size < 0)
-        throw invalid_argument("Block size cannot be negative.");
-    m_size = size;
-}
-
-
-// ---- Setters ---- //
-
-
-// Set the size of the memory block
-// Throws exception if the given size is negative
-void Block::setSize(int size) {
-    if (size < 0) {
-        throw invalid_argument("Block size cannot be negative.");
+// Validation of the checked build (MM_CHECKED); the accessors themselves
+// are inline in Block.h. Kept out of line so the throw code stays out of
+// every caller.
+
+// Throws invalid_argument if the size is larger than the layout can hold
+// (getMaxSize, which also catches negative values converted to size_t) or
+// is not a multiple of 8 (the low bits of the size word hold the flags)
+template <class Word>
+void BasicBlock<Word>::checkSize(size_t size) {
+    if (size > getMaxSize()) {
+        throw invalid_argument("Block size is out of range for this header layout.");
+    }
+    if (size & kFlagMask) {
+        throw invalid_argument("Block size must be a multiple of 8.");
     }
-    m_size = size;
-}
-
-
-
-// Set the free/used status of the block
-void Block::setFree(bool state) {
-    m_isFree = state;
 }
 
-// Set the pointer to the next block in the pool
-// Throws exception if trying to point to itself
-void Block::setNext(Block* next) {
+// Throws invalid_argument if the block would point to itself, or if the
+// distance does not fit in the offset word of this layout
+template <class Word>
+void BasicBlock<Word>::checkNext(const BasicBlock* next) const {
     if (next == this) {
         throw invalid_argument("Block cannot point to itself.");
     }
-    m_next = next;
-}
-
 
-// ---- Getters ---- //
-
-// Get the size of the block
-int Block::getSize() const {
-    return m_size;
+    ptrdiff_t offset = next ? (const char*)next - (const char*)this : 0;
+    if ((ptrdiff_t)(Offset)offset != offset) {
+        throw invalid_argument("Next block is out of range for this header layout.");
+    }
 }
 
-// Check if the block is free
-bool Block::isFree() const {
-    return m_isFree;
-}
 
-// Get the pointer to the next block
-Block* Block::getNext() {
-    return m_next;
+#if MM_HARDENED
+// Throws logic_error if the header no longer matches its checksum: something
+// wrote over it (an overrun of the block in front, or a stray pointer)
+template <class Word>
+void BasicBlock<Word>::checkIntact() const {
+    if (!isIntact()) {
+        throw logic_error("Heap corruption: block header was overwritten.");
+    }
 }
+#endif
 
 
-// Get the pointer to the next block (Const)
-const Block* Block::getNext() const {
-    return m_next;
-}
-
+// Layouts used by the memory managers
+template class BasicBlock<uint64_t>;
+template class BasicBlock<uint32_t>;
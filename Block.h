@@ -1,24 +1,276 @@
 #ifndef BLOCK_H
 #define BLOCK_H
 
-class Block {
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Checked accessors: setSize and setNext validate their argument and throw
+// invalid_argument on misuse (negative or unaligned sizes, a block linked to
+// itself, distances the layout cannot hold). On by default, off when NDEBUG
+// is defined; build with -DMM_CHECKED=0 or 1 to choose explicitly.
+// The unchecked accessors are plain bit operations the compiler can inline
+// into every split and merge.
+#ifndef MM_CHECKED
+#ifdef NDEBUG
+#define MM_CHECKED 0
+#else
+#define MM_CHECKED 1
+#endif
+#endif
+
+// Hardened mode (opt-in, build with -DMM_HARDENED=1) for hunting heap
+// corruption: every header carries a checksum that is verified before it is
+// changed, payloads are followed by red zones, freed blocks are poisoned and
+// held back in a quarantine, and double frees are reported. Off by default,
+// and then compiled out entirely - the header keeps its size and no check
+// runs.
+#ifndef MM_HARDENED
+#define MM_HARDENED 0
+#endif
+
+#if MM_HARDENED
+#define MM_HARDEN(statement) statement
+#else
+#define MM_HARDEN(statement)
+#endif
+
+// Header in front of every block of the pool.
+// The size and the state flags share one word (block sizes are multiples
+// of 8, so the low 3 bits hold the flags) and the next block is stored as
+// a relative offset instead of an absolute pointer. A free block also keeps
+// its size in the last word of its data (footer), which lets the following
+// block find it without a prev pointer.
+// 'Word' selects the layout: 64-bit words give a 16-byte header, 32-bit
+// words an 8-byte header for pools under 4 GiB (their next offsets only
+// point forward, as the next block always follows in its region). Hardened
+// builds add two words (the requested size and a checksum of the header).
+template <class Word>
+class BasicBlock {
     public:
-        Block(int size = 0);                 // Constructor
-        void setSize(int size);              // Set block size
+        typedef Word WordType;
+
+        BasicBlock(size_t size = 0);         // Constructor
+        void setSize(size_t size);           // Set block size
         void setFree(bool state);            // Set free/used status
-        void setNext(Block* next);           // Set pointer to next block
+        void setPrevFree(bool state);        // Set status of the previous block
+        void setMovable(bool state);         // Let compaction move the block
+        void setNext(BasicBlock* next);      // Set pointer to next block
 
-        int getSize() const;                 // Get block size
+        size_t getSize() const;              // Get block size
         bool isFree() const;                 // Is the block free ?
-        Block* getNext();                    // Get pointer to next block
-        const Block* getNext() const;   //Get pointer to next block(const) 
+        bool isPrevFree() const;             // Is the previous block free ?
+        bool isMovable() const;              // May compaction move the block ?
+        BasicBlock* getNext();               // Get pointer to next block
+        const BasicBlock* getNext() const;   //Get pointer to next block(const)
+
+        // Largest block size, and largest distance between two headers, this
+        // layout can hold; pools must be formatted in regions no larger
+        static size_t getMaxSize();
+
+#if MM_HARDENED
+        void setRequestSize(size_t size);    // Bytes asked for (the rest is red zone)
+        size_t getRequestSize() const;       // Bytes asked for
+        bool isIntact() const;               // Does the header match its checksum ?
+#endif
 
     private:
-        int m_size;       // Size of the memory block
-        bool m_isFree;    // True if the block is free
-        Block* m_next;    // Pointer to the next block 
+        // Distance to the next block: words narrower than a pointer hold an
+        // unsigned forward distance, which doubles their reach
+        typedef typename std::conditional<(sizeof(Word) < sizeof(std::ptrdiff_t)),
+            Word, typename std::make_signed<Word>::type>::type Offset;
+
+        static const Word kFreeFlag = 1;     // The block is free
+        static const Word kPrevFreeFlag = 2; // The previous block is free
+        static const Word kMovableFlag = 4;  // Owned by a handle, may be moved
+        static const Word kFlagMask = 7;     // Low bits reserved for flags
+
+        Word m_sizeAndFlags;  // Size of the memory block | state flags
+        Word m_nextOffset;    // Distance to the next block in bytes (0 = none)
+
+        // Validation of the checked build (Block.cpp), kept out of line
+        static void checkSize(size_t size);
+        void checkNext(const BasicBlock* next) const;
 
-        friend class MemoryManager;      // Allow MemoryManager full access
+#if MM_HARDENED
+        static const Word kChecksumSeed = (Word)0x9E3779B97F4A7C15ull;
+        static const Word kChecksumPrime = (Word)0x100000001B3ull;
+
+        Word m_requestSize;   // Bytes the caller asked for
+        Word m_checksum;      // Hash of the other words
+
+        Word checksum() const;                     // Hash of the header words
+        void seal() { m_checksum = checksum(); }   // Accept the current words
+        void checkIntact() const;                  // Throws if the header was overwritten
+#endif
+
+        template <class> friend class BasicMemoryManager; // Allow full access
 };
 
+typedef BasicBlock<uint64_t> Block;          // 16-byte header (default layout)
+typedef BasicBlock<uint32_t> CompactBlock;   // 8-byte header, pools under 4 GiB
+
+
+// The accessors run on every split, merge and search step, so they are
+// defined here where they can be inlined
+
+// Constructor
+template <class Word>
+inline BasicBlock<Word>::BasicBlock(size_t size)
+    : m_sizeAndFlags(kFreeFlag), m_nextOffset(0) {
+    MM_HARDEN(m_requestSize = 0);
+    MM_HARDEN(seal());
+    setSize(size);
+}
+
+
+// ---- Setters ---- //
+
+// Set the size of the memory block
+// Checked builds throw if the size does not fit the layout or is not a
+// multiple of 8 (the low bits of the size word hold the flags)
+template <class Word>
+inline void BasicBlock<Word>::setSize(size_t size) {
+#if MM_CHECKED
+    checkSize(size);
+#endif
+    MM_HARDEN(checkIntact());
+    m_sizeAndFlags = (Word)size | (m_sizeAndFlags & kFlagMask);
+    MM_HARDEN(seal());
+}
+
+// Set the free/used status of the block
+template <class Word>
+inline void BasicBlock<Word>::setFree(bool state) {
+    MM_HARDEN(checkIntact());
+    if (state)
+        m_sizeAndFlags |= kFreeFlag;
+    else
+        m_sizeAndFlags &= ~kFreeFlag;
+    MM_HARDEN(seal());
+}
+
+// Record whether the block right before this one is free
+template <class Word>
+inline void BasicBlock<Word>::setPrevFree(bool state) {
+    MM_HARDEN(checkIntact());
+    if (state)
+        m_sizeAndFlags |= kPrevFreeFlag;
+    else
+        m_sizeAndFlags &= ~kPrevFreeFlag;
+    MM_HARDEN(seal());
+}
+
+// Record whether the block is reached through a handle, so compaction can
+// move it and update the handle
+template <class Word>
+inline void BasicBlock<Word>::setMovable(bool state) {
+    MM_HARDEN(checkIntact());
+    if (state)
+        m_sizeAndFlags |= kMovableFlag;
+    else
+        m_sizeAndFlags &= ~kMovableFlag;
+    MM_HARDEN(seal());
+}
+
+// Set the pointer to the next block in the pool
+// Checked builds throw if the block would point to itself or the distance
+// does not fit in the offset word of this layout (compact blocks can only
+// point forward)
+template <class Word>
+inline void BasicBlock<Word>::setNext(BasicBlock* next) {
+#if MM_CHECKED
+    checkNext(next);
+#endif
+    MM_HARDEN(checkIntact());
+    m_nextOffset = next ? (Word)((char*)next - (char*)this) : 0;
+    MM_HARDEN(seal());
+}
+
+
+// ---- Getters ---- //
+
+// Get the size of the block
+template <class Word>
+inline size_t BasicBlock<Word>::getSize() const {
+    return (size_t)(m_sizeAndFlags & ~kFlagMask);
+}
+
+// Check if the block is free
+template <class Word>
+inline bool BasicBlock<Word>::isFree() const {
+    return (m_sizeAndFlags & kFreeFlag) != 0;
+}
+
+// Check if the block right before this one is free
+template <class Word>
+inline bool BasicBlock<Word>::isPrevFree() const {
+    return (m_sizeAndFlags & kPrevFreeFlag) != 0;
+}
+
+// Check if compaction may move the block
+template <class Word>
+inline bool BasicBlock<Word>::isMovable() const {
+    return (m_sizeAndFlags & kMovableFlag) != 0;
+}
+
+// Get the pointer to the next block
+template <class Word>
+inline BasicBlock<Word>* BasicBlock<Word>::getNext() {
+    return m_nextOffset ? (BasicBlock*)((char*)this + (Offset)m_nextOffset) : nullptr;
+}
+
+// Get the pointer to the next block (Const)
+template <class Word>
+inline const BasicBlock<Word>* BasicBlock<Word>::getNext() const {
+    return m_nextOffset ? (const BasicBlock*)((const char*)this + (Offset)m_nextOffset) : nullptr;
+}
+
+// A layout reaches as far as its next offsets (the whole word range for
+// compact forward offsets, half of it for signed ones)
+template <class Word>
+inline size_t BasicBlock<Word>::getMaxSize() {
+    size_t limit = (size_t)std::numeric_limits<Offset>::max();
+    if (limit > (size_t)PTRDIFF_MAX) {
+        limit = (size_t)PTRDIFF_MAX;
+    }
+    return limit & ~(size_t)kFlagMask;
+}
+
+
+#if MM_HARDENED
+
+// Record the size the caller asked for; the data past it is red zone
+template <class Word>
+inline void BasicBlock<Word>::setRequestSize(size_t size) {
+    checkIntact();
+    m_requestSize = (Word)size;
+    seal();
+}
+
+// Get the size the caller asked for
+template <class Word>
+inline size_t BasicBlock<Word>::getRequestSize() const {
+    return (size_t)m_requestSize;
+}
+
+// Check the header words against the checksum written with them
+template <class Word>
+inline bool BasicBlock<Word>::isIntact() const {
+    return m_checksum == checksum();
+}
+
+// FNV-style hash of the size, flags, next offset and requested size
+template <class Word>
+inline Word BasicBlock<Word>::checksum() const {
+    Word hash = kChecksumSeed;
+    hash = (Word)((hash ^ m_sizeAndFlags) * kChecksumPrime);
+    hash = (Word)((hash ^ m_nextOffset) * kChecksumPrime);
+    hash = (Word)((hash ^ m_requestSize) * kChecksumPrime);
+    return (Word)(hash ^ (hash >> (sizeof(Word) * 4)));
+}
+
+#endif // MM_HARDENED
+
 #endif // BLOCK_H
@@ -0,0 +1,377 @@
+#include "BuddyAllocator.h"
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+
+// Constructor - delegates the pool to the base class and builds the arena
+// Throws invalid_argument if the minimum block size is not a power of two
+// large enough for the free-list links, or larger than the pool
+BuddyAllocator::BuddyAllocator(size_t poolSize, size_t minBlockSize,
+    const BackingStore& backing)
+    : MemoryManager(poolSize, backing), m_minBlockSize(minBlockSize),
+    m_internalWaste(0), m_peakInternalWaste(0) {
+    if (minBlockSize < sizeof(FreeLinks) || (minBlockSize & (minBlockSize - 1)) != 0) {
+        throw invalid_argument("Minimum block size must be a power of two holding two pointers.");
+    }
+    if (minBlockSize > poolSize) {
+        throw invalid_argument("Minimum block size is larger than the pool.");
+    }
+    initBuddies();
+}
+
+// Return name of the algorithm
+const char* BuddyAllocator::getAlgorithmName() const {
+    return "Buddy";
+}
+
+
+// Allocate the smallest power-of-two block that fits 'size'
+// Larger free blocks are split in halves until the order matches
+// Throws invalid_argument if requested size is zero
+void* BuddyAllocator::allocate(size_t size) {
+    if (size == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+
+    // Smallest order whose block holds the request
+    int order = 0;
+    while (order <= m_maxOrder && (m_minBlockSize << order) < size) {
+        order++;
+    }
+
+    // Smallest order at or above it with a free block
+    int from = order;
+    while (from <= m_maxOrder && !m_freeLists[from]) {
+        from++;
+    }
+    MM_STAT(countScan(m_stats.allocateScans, from - order + (from > m_maxOrder ? 0 : 1)));
+    if (from > m_maxOrder) {
+        m_failedAllocations++;
+        return traceAllocate(size, 0, nullptr);
+    }
+
+    size_t offset = m_freeLists[from] - m_poolBuffer;
+    removeFree(from, offset);
+
+    // Split down to the requested order, freeing the upper halves
+    while (from > order) {
+        m_splitMap[nodeIndex(from, offset)] = true;
+        from--;
+        pushFree(from, offset + (m_minBlockSize << from));
+        MM_STAT(m_stats.splits++);
+    }
+
+    // Update usage statistics, including the rounding waste
+    size_t blockSize = m_minBlockSize << order;
+    m_requested[offset / m_minBlockSize] = size;
+    m_usedSize += blockSize;
+    m_internalWaste += blockSize - size;
+    MM_STAT(m_stats.internalWaste += blockSize - size);
+    if (m_usedSize > m_peakUsage) {
+        m_peakUsage = m_usedSize;
+    }
+    if (m_internalWaste > m_peakInternalWaste) {
+        m_peakInternalWaste = m_internalWaste;
+    }
+
+    return traceAllocate(size, 0, m_poolBuffer + offset);
+}
+
+
+
+// Blocks are aligned to their power-of-two size inside the pool, so an
+// aligned request is served by a block of at least max(size, alignment)
+// Pools start on a page boundary, so alignments up to a page are met
+// whenever a large enough block is free; larger ones may fail
+// Throws invalid_argument if size is zero or alignment is invalid
+void* BuddyAllocator::allocate(size_t size, size_t alignment) {
+    if (size == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+    if (!isValidAlignment(alignment)) {
+        throw invalid_argument("Alignment must be a power of two.");
+    }
+
+    TraceScope trace(this);
+    void* ptr = allocate(size < alignment ? alignment : size);
+    if (ptr && ((size_t)ptr & (alignment - 1)) != 0) {
+        deallocate(ptr);
+        m_failedAllocations++;
+        return trace.allocated(size, alignment, nullptr);
+    }
+    return trace.allocated(size, alignment, ptr);
+}
+
+
+// Free a block and merge it with its buddy for as long as the buddy is free
+// Does nothing if the pointer is null or the block is already free
+// Throws std::out_of_range if the pointer is not the start of a block
+void BuddyAllocator::deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    int order = 0;
+    size_t offset = blockOffset(ptr, order);
+    if (m_freeMap[nodeIndex(order, offset)]) {
+        return; // Already free
+    }
+    traceFree(ptr);
+
+    size_t blockSize = m_minBlockSize << order;
+    m_usedSize -= blockSize;
+    m_internalWaste -= blockSize - m_requested[offset / m_minBlockSize];
+
+    // Coalesce with the buddy (offset XOR size) while it is free
+    MM_STAT(size_t examined = 1);
+    while (order < m_maxOrder) {
+        size_t buddy = offset ^ (m_minBlockSize << order);
+        MM_STAT(examined++);
+        if (!m_freeMap[nodeIndex(order, buddy)]) {
+            break;
+        }
+        removeFree(order, buddy);
+        MM_STAT(m_stats.merges++);
+        if (buddy < offset) {
+            offset = buddy;
+        }
+        order++;
+        m_splitMap[nodeIndex(order, offset)] = false;
+    }
+    MM_STAT(countScan(m_stats.deallocateScans, examined));
+
+    pushFree(order, offset);
+}
+
+
+// Resize a block
+//  - shrinking gives the upper halves back while the data fits in half
+//  - growing merges with the free upper buddies while the block is their
+//    lower half
+//  - otherwise the data moves to a new block
+// Throws invalid_argument if the new size is zero
+// Throws std::out_of_range if the pointer is not a used block
+void* BuddyAllocator::reallocate(void* ptr, size_t newSize) {
+    if (!ptr) {
+        return allocate(newSize);
+    }
+    if (newSize == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+    int order = 0;
+    size_t offset = blockOffset(ptr, order);
+    if (m_freeMap[nodeIndex(order, offset)]) {
+        throw out_of_range("Cannot reallocate: block is not in use.");
+    }
+    size_t oldSize = m_minBlockSize << order;
+    TraceScope trace(this);
+
+    // Order the new size needs, if the upper buddies on the way are free
+    int target = order;
+    while (target < m_maxOrder && (m_minBlockSize << target) < newSize) {
+        size_t buddy = offset + (m_minBlockSize << target);
+        if ((offset & (m_minBlockSize << target)) != 0 || !m_freeMap[nodeIndex(target, buddy)]) {
+            break;
+        }
+        target++;
+    }
+
+    if ((m_minBlockSize << target) >= newSize) {
+        // Grow in place
+        for (; order < target; order++) {
+            removeFree(order, offset + (m_minBlockSize << order));
+            m_splitMap[nodeIndex(order + 1, offset)] = false;
+            MM_STAT(m_stats.merges++);
+        }
+
+        // Shrink in place
+        while (order > 0 && (m_minBlockSize << (order - 1)) >= newSize) {
+            m_splitMap[nodeIndex(order, offset)] = true;
+            order--;
+            pushFree(order, offset + (m_minBlockSize << order));
+            MM_STAT(m_stats.splits++);
+        }
+
+        size_t blockSize = m_minBlockSize << order;
+        m_usedSize += blockSize - oldSize;
+        m_internalWaste += blockSize - newSize;
+        MM_STAT(m_stats.internalWaste += blockSize - newSize);
+        m_internalWaste -= oldSize - m_requested[offset / m_minBlockSize];
+        m_requested[offset / m_minBlockSize] = newSize;
+        if (m_usedSize > m_peakUsage) {
+            m_peakUsage = m_usedSize;
+        }
+        if (m_internalWaste > m_peakInternalWaste) {
+            m_peakInternalWaste = m_internalWaste;
+        }
+        return trace.reallocated(ptr, newSize, ptr);
+    }
+
+    // Move as a last resort
+    void* moved = allocate(newSize);
+    if (!moved) {
+        return trace.reallocated(ptr, newSize, nullptr);
+    }
+    memcpy(moved, ptr, oldSize);
+    deallocate(ptr);
+    return trace.reallocated(ptr, newSize, moved);
+}
+
+
+// Reset the memory pool to one free block of the highest order
+void BuddyAllocator::reset(size_t poolSize) {
+    if (m_minBlockSize > poolSize) {
+        throw invalid_argument("Minimum block size is larger than the pool.");
+    }
+    MemoryManager::reset(poolSize);
+    initBuddies();
+}
+
+
+// Free every block by clearing the bitmaps and the free lists
+// Requested sizes are rewritten by the next allocation of each block
+void BuddyAllocator::releaseAll() {
+    m_freeLists.assign(m_freeLists.size(), nullptr);
+    m_splitMap.assign(m_splitMap.size(), false);
+    m_freeMap.assign(m_freeMap.size(), false);
+    m_internalWaste = 0;
+    m_usedSize = 0;
+
+    pushFree(m_maxOrder, 0);
+}
+
+
+// Return the bytes of live blocks that were not requested by the user
+size_t BuddyAllocator::getInternalFragmentation() const {
+    return m_internalWaste;
+}
+
+// Return the highest internal fragmentation seen since the last reset
+size_t BuddyAllocator::getPeakInternalFragmentation() const {
+    return m_peakInternalWaste;
+}
+
+// Return the statistics, with the free blocks read from the free lists
+// The largest free block is the head of the highest non-empty order
+MemoryStats BuddyAllocator::getStats() const {
+    MemoryStats stats = MemoryManager::getStats();
+    size_t totalFree = 0;
+    for (int order = 0; order <= m_maxOrder; order++) {
+        for (char* block = m_freeLists[order]; block; block = ((FreeLinks*)block)->next) {
+            stats.freeBlocks++;
+            totalFree += m_minBlockSize << order;
+            stats.largestFreeBlock = m_minBlockSize << order;
+        }
+    }
+    stats.externalFragmentation =
+        totalFree ? 1.0 - (double)stats.largestFreeBlock / totalFree : 0.0;
+    return stats;
+}
+
+// Return the number of bytes managed by the buddy system
+size_t BuddyAllocator::getArenaSize() const {
+    return m_arenaSize;
+}
+
+
+// Return the offset and order of the block starting at 'ptr'
+// Throws std::out_of_range if the pointer is outside the arena or not the
+// start of a block
+size_t BuddyAllocator::blockOffset(void* ptr, int& order) const {
+    // Range check - the pointer must lie inside the arena
+    char* data = (char*)ptr;
+    if (data < m_poolBuffer || data >= m_poolBuffer + m_arenaSize) {
+        throw out_of_range("Cannot deallocate: pointer does not belong to memory pool.");
+    }
+
+    // Locate the block through the split bitmap
+    size_t offset = findLeaf(data - m_poolBuffer, order);
+    if (m_poolBuffer + offset != data) {
+        throw out_of_range("Cannot deallocate: pointer is not the start of a block.");
+    }
+    return offset;
+}
+
+
+// Return the bit of a block in the split/free bitmaps
+// Blocks are numbered like a heap: the whole arena is 1, its halves 2 and 3...
+size_t BuddyAllocator::nodeIndex(int order, size_t offset) const {
+    return ((size_t)1 << (m_maxOrder - order)) + offset / (m_minBlockSize << order);
+}
+
+// Return the offset of the unsplit block containing 'offset' and its order
+// Walks down from the top block following the split bits
+size_t BuddyAllocator::findLeaf(size_t offset, int& order) const {
+    size_t start = 0;
+    order = m_maxOrder;
+    while (order > 0 && m_splitMap[nodeIndex(order, start)]) {
+        order--;
+        start = offset - offset % (m_minBlockSize << order);
+    }
+    return start;
+}
+
+
+// Push a block onto the free list of its order and mark it free
+void BuddyAllocator::pushFree(int order, size_t offset) {
+    char* block = m_poolBuffer + offset;
+    FreeLinks* links = (FreeLinks*)block;
+
+    links->prev = nullptr;
+    links->next = m_freeLists[order];
+    if (links->next) {
+        ((FreeLinks*)links->next)->prev = block;
+    }
+    m_freeLists[order] = block;
+    m_freeMap[nodeIndex(order, offset)] = true;
+}
+
+// Unlink a block from the free list of its order and mark it used
+void BuddyAllocator::removeFree(int order, size_t offset) {
+    FreeLinks* links = (FreeLinks*)(m_poolBuffer + offset);
+
+    if (links->prev) {
+        ((FreeLinks*)links->prev)->next = links->next;
+    }
+    else {
+        m_freeLists[order] = links->next;
+    }
+    if (links->next) {
+        ((FreeLinks*)links->next)->prev = links->prev;
+    }
+    m_freeMap[nodeIndex(order, offset)] = false;
+}
+
+
+// Size the arena to the pool and make it a single free block
+void BuddyAllocator::initBuddies() {
+    m_maxOrder = 0;
+    while ((m_totalSize >> (m_maxOrder + 1)) >= m_minBlockSize) {
+        m_maxOrder++;
+    }
+    m_arenaSize = m_minBlockSize << m_maxOrder;
+
+    m_freeLists.assign(m_maxOrder + 1, nullptr);
+    m_splitMap.assign((size_t)2 << m_maxOrder, false);
+    m_freeMap.assign((size_t)2 << m_maxOrder, false);
+    m_requested.assign(m_arenaSize / m_minBlockSize, 0);
+    m_internalWaste = 0;
+    m_peakInternalWaste = 0;
+
+    pushFree(m_maxOrder, 0);
+}
+
+
+// Print every block of the arena in address order
+void BuddyAllocator::printBlocks(ostream& os) const {
+    int index = 0;
+    for (size_t offset = 0; offset < m_arenaSize; ) {
+        int order = 0;
+        findLeaf(offset, order);
+        os << "Block " << index++ << ": size=" << (m_minBlockSize << order)
+            << ", free=" << (m_freeMap[nodeIndex(order, offset)] ? "yes" : "no") << "\n";
+        offset += m_minBlockSize << order;
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef BUDDY_ALLOCATOR_H
+#define BUDDY_ALLOCATOR_H
+
+#include "MemoryManager.h"
+#include <vector>
+
+// Binary buddy allocator.
+// The pool is managed as a power-of-two arena split into blocks of
+// minBlockSize << order. Each order has its own free list, the buddy of a
+// block is found by XOR-ing its offset with its size, and the state of
+// every block (split / free) is kept in bitmaps, so allocate and deallocate
+// take at most one step per order - O(log poolSize).
+class BuddyAllocator : public MemoryManager {
+
+    public:
+        // Constructor - initialize memory pool with given size
+        // Only the largest power of two that fits in the pool is used
+        BuddyAllocator(size_t poolSize, size_t minBlockSize = 16,
+            const BackingStore& backing = BackingStore());
+
+        // Allocate the smallest power-of-two block that fits 'size'
+        void* allocate(size_t size);
+
+        // Allocate a block whose address is a multiple of 'alignment'
+        void* allocate(size_t size, size_t alignment);
+
+        // Free a block and coalesce it with its free buddies
+        void deallocate(void* ptr);
+
+        // Resize in place through split/merge of buddies, or move the block
+        void* reallocate(void* ptr, size_t newSize);
+
+        // Reset the pool to a single free block of the highest order
+        void reset(size_t poolSize);
+
+        // Free every block at once, keeping the arena and peak statistics
+        void releaseAll();
+
+        // Return the name of the allocation algorithm
+        const char* getAlgorithmName() const;
+
+        /// --- Internal fragmentation statistics --- ///
+
+        size_t getInternalFragmentation() const;     // Rounding waste in live blocks
+        size_t getPeakInternalFragmentation() const; // Highest rounding waste seen
+        size_t getArenaSize() const;                 // Bytes managed by the buddies
+
+        // Statistics with the free blocks of every order
+        MemoryStats getStats() const;
+
+    protected:
+        // Print every block of the arena in address order
+        void printBlocks(std::ostream& os) const;
+
+    private:
+        // Links of the per-order free lists, stored in free blocks
+        struct FreeLinks {
+            char* prev;
+            char* next;
+        };
+
+        size_t nodeIndex(int order, size_t offset) const; // Bit of a block in the maps
+        size_t findLeaf(size_t offset, int& order) const; // Block containing an offset
+        size_t blockOffset(void* ptr, int& order) const;  // Block starting at 'ptr'
+        void pushFree(int order, size_t offset);          // Add block to its free list
+        void removeFree(int order, size_t offset);        // Unlink block from free list
+        void initBuddies();                           // Single free top block
+
+        size_t m_minBlockSize;          // Size of an order-0 block
+        int m_maxOrder;                 // Order of the whole arena
+        size_t m_arenaSize;             // minBlockSize << maxOrder
+        size_t m_internalWaste;         // Block bytes not requested by the user
+        size_t m_peakInternalWaste;     // Maximum of m_internalWaste
+        std::vector<char*> m_freeLists; // Free blocks per order
+        std::vector<bool> m_splitMap;   // Block has been split into buddies
+        std::vector<bool> m_freeMap;    // Block is on a free list
+        std::vector<size_t> m_requested; // Requested size per order-0 unit
+};
+
+
+#endif // BUDDY_ALLOCATOR_H
@@ -0,0 +1,256 @@
+#include "ConcurrentAllocator.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <stdexcept>
+
+using namespace std;
+
+namespace {
+
+    // Link stored in the data area of a cached (free) block
+    struct FreeObject {
+        FreeObject* next;
+    };
+
+    // Last cache used by this thread, avoids taking the lock on every call
+    struct CacheLookup {
+        unsigned long ownerId;  // Id of the allocator the cache belongs to
+        void* cache;            // The cache itself
+    };
+
+    thread_local CacheLookup t_lastCache = { 0, nullptr };
+
+    atomic<unsigned long> s_nextId(1); // Ids are never reused, unlike addresses
+}
+
+
+// Blocks cached by one thread, grouped by size class
+struct ConcurrentAllocator::ThreadCache {
+    thread::id threadId;                        // Thread that owns the cache
+    FreeObject* freeLists[kNumCacheClasses];    // Cached blocks per class
+    int counts[kNumCacheClasses];               // Length of each list
+    atomic<FreeObject*> remoteFrees;            // Blocks freed by other threads
+    vector<void*> batch;                        // Blocks moved by a refill or flush
+
+    ThreadCache(thread::id id) : threadId(id), remoteFrees(nullptr) {
+        for (int i = 0; i < kNumCacheClasses; i++) {
+            freeLists[i] = nullptr;
+            counts[i] = 0;
+        }
+    }
+};
+
+
+// Constructor
+// Throws invalid_argument if the batch size is not positive
+ConcurrentAllocator::ConcurrentAllocator(MemoryManager& backend, int batchSize)
+    : m_backend(backend), m_batchSize(batchSize), m_id(s_nextId++) {
+    if (batchSize <= 0) {
+        throw invalid_argument("Batch size must be positive.");
+    }
+}
+
+// Destructor - drains every cache back into the pool
+ConcurrentAllocator::~ConcurrentAllocator() {
+    for (size_t i = 0; i < m_caches.size(); i++) {
+        ThreadCache* cache = m_caches[i];
+        drainRemoteFrees(cache);
+        for (int cls = 0; cls < kNumCacheClasses; cls++) {
+            flush(cache, cls, cache->counts[cls]);
+        }
+        delete cache;
+    }
+}
+
+
+// Allocate memory from the calling thread's cache (refilled in batches)
+// Throws invalid_argument if size is zero
+void* ConcurrentAllocator::allocate(size_t size) {
+    if (size == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+
+    size_t cls = (size - 1) / kClassGranularity;
+
+    // Large request - allocate directly from the shared pool
+    if (cls >= (size_t)kNumCacheClasses) {
+        if (size > SIZE_MAX - sizeof(ObjectHeader)) {
+            return nullptr; // No room for the prefix
+        }
+        lock_guard<mutex> guard(m_lock);
+        ObjectHeader* header = (ObjectHeader*)m_backend.allocate(size + sizeof(ObjectHeader));
+        if (!header) {
+            return nullptr;
+        }
+        header->owner = nullptr;
+        header->sizeClass = -1;
+        return header + 1;
+    }
+
+    ThreadCache* cache = getThreadCache();
+    if (!cache->freeLists[cls]) {
+        // Reclaim blocks other threads gave back before touching the pool
+        drainRemoteFrees(cache);
+        if (!cache->freeLists[cls] && !refill(cache, cls)) {
+            return nullptr;
+        }
+    }
+
+    // Pop a cached block
+    FreeObject* object = cache->freeLists[cls];
+    cache->freeLists[cls] = object->next;
+    cache->counts[cls]--;
+    return object;
+}
+
+
+// Free memory allocated by any thread
+// Does nothing if the pointer is null
+void ConcurrentAllocator::deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    ObjectHeader* header = (ObjectHeader*)ptr - 1;
+    FreeObject* object = (FreeObject*)ptr;
+
+    // Large block - return it straight to the shared pool
+    if (!header->owner) {
+        lock_guard<mutex> guard(m_lock);
+        m_backend.deallocate(header);
+        return;
+    }
+
+    ThreadCache* cache = getThreadCache();
+    if (header->owner != cache) {
+        // Remote free - push onto the owner's lock-free list
+        ThreadCache* owner = header->owner;
+        FreeObject* head = owner->remoteFrees.load(memory_order_relaxed);
+        do {
+            object->next = head;
+        } while (!owner->remoteFrees.compare_exchange_weak(head, object,
+            memory_order_release, memory_order_relaxed));
+        return;
+    }
+
+    // Local free - push onto the cache, flush a batch if it grew too large
+    int cls = header->sizeClass;
+    object->next = cache->freeLists[cls];
+    cache->freeLists[cls] = object;
+    cache->counts[cls]++;
+    if (cache->counts[cls] > 2 * m_batchSize) {
+        flush(cache, cls, m_batchSize);
+    }
+}
+
+
+// Return every block cached by the calling thread to the pool
+void ConcurrentAllocator::flushThreadCache() {
+    ThreadCache* cache = getThreadCache();
+    drainRemoteFrees(cache);
+    for (int cls = 0; cls < kNumCacheClasses; cls++) {
+        flush(cache, cls, cache->counts[cls]);
+    }
+}
+
+
+// Return the shared pool
+MemoryManager& ConcurrentAllocator::getBackend() {
+    return m_backend;
+}
+
+// Return the number of blocks moved per refill/flush
+int ConcurrentAllocator::getBatchSize() const {
+    return m_batchSize;
+}
+
+
+// Find (or create) the cache of the calling thread
+// The last lookup is remembered per thread, so the lock is only taken
+// the first time a thread uses this allocator
+ConcurrentAllocator::ThreadCache* ConcurrentAllocator::getThreadCache() {
+    if (t_lastCache.ownerId == m_id) {
+        return (ThreadCache*)t_lastCache.cache;
+    }
+
+    lock_guard<mutex> guard(m_lock);
+    thread::id self = this_thread::get_id();
+    ThreadCache* cache = nullptr;
+    for (size_t i = 0; i < m_caches.size() && !cache; i++) {
+        if (m_caches[i]->threadId == self) {
+            cache = m_caches[i];
+        }
+    }
+    if (!cache) {
+        cache = new ThreadCache(self);
+        m_caches.push_back(cache);
+    }
+
+    t_lastCache.ownerId = m_id;
+    t_lastCache.cache = cache;
+    return cache;
+}
+
+
+// Allocate a batch of blocks of one class from the pool in a single call
+// under a single lock
+// Returns false if the pool could not provide any block
+bool ConcurrentAllocator::refill(ThreadCache* cache, int cls) {
+    size_t objectSize = (cls + 1) * kClassGranularity + sizeof(ObjectHeader);
+
+    cache->batch.resize(m_batchSize);
+    {
+        lock_guard<mutex> guard(m_lock);
+        m_backend.allocateBatch(objectSize, m_batchSize, cache->batch.data());
+    }
+
+    for (int i = 0; i < m_batchSize; i++) {
+        ObjectHeader* header = (ObjectHeader*)cache->batch[i];
+        if (!header) {
+            continue; // Pool exhausted - keep what we got
+        }
+        header->owner = cache;
+        header->sizeClass = cls;
+
+        FreeObject* object = (FreeObject*)(header + 1);
+        object->next = cache->freeLists[cls];
+        cache->freeLists[cls] = object;
+        cache->counts[cls]++;
+    }
+    return cache->freeLists[cls] != nullptr;
+}
+
+
+// Return up to 'count' cached blocks of one class to the pool in a single
+// call under a single lock
+void ConcurrentAllocator::flush(ThreadCache* cache, int cls, int count) {
+    cache->batch.clear();
+    while (count-- > 0 && cache->freeLists[cls]) {
+        FreeObject* object = cache->freeLists[cls];
+        cache->freeLists[cls] = object->next;
+        cache->counts[cls]--;
+        cache->batch.push_back((ObjectHeader*)object - 1);
+    }
+    if (cache->batch.empty()) {
+        return;
+    }
+
+    lock_guard<mutex> guard(m_lock);
+    m_backend.deallocateBatch(cache->batch.data(), cache->batch.size());
+}
+
+
+// Move every block freed remotely into the cache's local lists
+// The whole list is taken at once, so only other threads ever push
+void ConcurrentAllocator::drainRemoteFrees(ThreadCache* cache) {
+    FreeObject* object = cache->remoteFrees.exchange(nullptr, memory_order_acquire);
+    while (object) {
+        FreeObject* next = object->next;
+        int cls = ((ObjectHeader*)object - 1)->sizeClass;
+        object->next = cache->freeLists[cls];
+        cache->freeLists[cls] = object;
+        cache->counts[cls]++;
+        object = next;
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef CONCURRENT_ALLOCATOR_H
+#define CONCURRENT_ALLOCATOR_H
+
+#include "MemoryManager.h"
+#include <mutex>
+#include <vector>
+
+// Thread-safe front end for any MemoryManager.
+// Small requests are served from per-thread caches that are refilled from
+// and flushed to the shared pool in batches, so the pool lock is taken once
+// per batch instead of once per call. Large requests go straight to the pool.
+// A block freed by a thread other than the one that allocated it is pushed
+// onto the owner's lock-free remote-free list and reclaimed by the owner.
+class ConcurrentAllocator {
+
+    public:
+        static const int kClassGranularity = 16;  // Size step between cache classes
+        static const int kNumCacheClasses = 16;   // Cached sizes: 16 .. 256 bytes
+
+        // Constructor - wraps the given pool, which must outlive this object
+        ConcurrentAllocator(MemoryManager& backend, int batchSize = 32);
+
+        // Destructor - returns every cached block to the pool
+        // All threads using the allocator must have finished
+        ~ConcurrentAllocator();
+
+        void* allocate(size_t size);    // Allocate memory (any thread)
+        void deallocate(void* ptr);     // Free memory (any thread)
+
+        // Return the calling thread's cached blocks to the pool
+        // Call before a thread exits to make its cache available again
+        void flushThreadCache();
+
+        MemoryManager& getBackend();    // The shared pool
+        int getBatchSize() const;       // Blocks moved per refill/flush
+
+    private:
+        struct ThreadCache;
+
+        // Prefix in front of every block handed out by this allocator
+        struct ObjectHeader {
+            ThreadCache* owner;         // Owning cache, nullptr for large blocks
+            int sizeClass;              // Cache class of the block
+        };
+
+        ThreadCache* getThreadCache();               // Cache of calling thread
+        bool refill(ThreadCache* cache, int cls);    // Batch allocate from pool
+        void flush(ThreadCache* cache, int cls, int count); // Batch free to pool
+        void drainRemoteFrees(ThreadCache* cache);   // Adopt remotely freed blocks
+
+        MemoryManager& m_backend;       // Shared memory pool
+        std::mutex m_lock;              // Guards m_backend and m_caches
+        std::vector<ThreadCache*> m_caches; // One cache per thread seen so far
+        int m_batchSize;                // Blocks moved per refill/flush
+        unsigned long m_id;             // Unique id for thread-local lookup
+
+        // Not copyable - caches point back to this instance
+        ConcurrentAllocator(const ConcurrentAllocator&);
+        ConcurrentAllocator& operator=(const ConcurrentAllocator&);
+};
+
+#endif // CONCURRENT_ALLOCATOR_H
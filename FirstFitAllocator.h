@@ -1,26 +1,35 @@
 #ifndef FIRST_FIT_ALLOCATOR_H
 #define FIRST_FIT_ALLOCATOR_H
 
-#include "MemoryManager.h"
+#include "FitPolicy.h"
 
 
 
-class FirstFitAllocator : public MemoryManager {
+template <class Header>
+class BasicFirstFitAllocator : public BasicMemoryManager<Header> {
+
+    protected:
+        typedef BasicMemoryManager<Header> Base;
 
     public:
         // Constructor - initialize memory pool with given size
-        FirstFitAllocator(int poolSize);
+        BasicFirstFitAllocator(size_t poolSize,
+            const BackingStore& backing = BackingStore());
 
         // Allocate memory block using first-fit algorithm
-        void* allocate(int size);
+        // (the FirstFit policy, through the virtual interface)
+        void* allocate(size_t size);
+        using Base::allocate;          // Aligned overload
 
         // Return the name of the allocation algorithm
         const char* getAlgorithmName() const;
-
-    private:
-        // Find the first free block that fits the requested size
-        Block* findFirstFit(int size);
 };
 
+// Allocator with the default 16-byte block header
+typedef BasicFirstFitAllocator<Block> FirstFitAllocator;
+
+// Allocator with the 8-byte block header (pools under 4 GiB)
+typedef BasicFirstFitAllocator<CompactBlock> CompactFirstFitAllocator;
+
 
 #endif // FIRST_FIT_ALLOCATOR_H
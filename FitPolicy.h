@@ -0,0 +1,172 @@
+#ifndef FIT_POLICY_H
+#define FIT_POLICY_H
+
+#include "MemoryManager.h"
+
+// Fit policies: the free-block search of each strategy, chosen at compile
+// time. PoolAllocator<Fit, Header, Lock> inlines them into its allocate; the
+// classic allocators (FirstFitAllocator, ...) are thin virtual adapters over
+// the same searches.
+//
+// A policy provides
+//   kAddressOrdered       size classes of its pool sorted by address (else by size)
+//   getName(compact)      name of the strategy (with the compact suffix)
+//   find(pool, size)      a free block of at least 'size' bytes, or nullptr
+//   placed(pool, block)   called once 'block' has been handed out
+
+
+// Lowest-addressed fitting block, as a walk over the pool would find it
+// The size classes are sorted by address, so the candidates are the first
+// fitting block of the request's class and the head of every larger
+// non-empty class (where every block fits)
+struct FirstFit {
+    static const bool kAddressOrdered = true;
+
+    static const char* getName(bool compact) {
+        return compact ? "First Fit (compact)" : "First Fit";
+    }
+
+    template <class Header>
+    static Header* find(BasicMemoryManager<Header>& pool, size_t size) {
+        Header* firstFit = nullptr;
+        int cls = pool.sizeClass(size);
+
+        // Blocks in the request's class may still be too small
+        for (Header* current = pool.m_freeLists[cls]; current; current = pool.nextFree(current)) {
+            pool.m_searchSteps++;
+            if (current->getSize() >= size) {
+                firstFit = current; // Lowest fitting block of the class
+                break;
+            }
+        }
+
+        // Any block of a larger class is big enough
+        for (int larger = pool.findNonEmptyClass(cls + 1); larger >= 0;
+            larger = pool.findNonEmptyClass(larger + 1)) {
+            pool.m_searchSteps++;
+            if (!firstFit || pool.m_freeLists[larger] < firstFit) {
+                firstFit = pool.m_freeLists[larger];
+            }
+        }
+        return firstFit;
+    }
+
+    template <class Header>
+    static void placed(BasicMemoryManager<Header>&, Header*) {}
+};
+
+
+// Smallest fitting block
+// Class lists are sorted by size, so the answer is the first fitting block
+// of the request's own class (its lower bound), or the head of the next
+// non-empty class (a bitmap lookup) when even the class's largest block is
+// too small
+struct BestFit {
+    static const bool kAddressOrdered = false;
+
+    static const char* getName(bool compact) {
+        return compact ? "Best Fit (compact)" : "Best Fit";
+    }
+
+    template <class Header>
+    static Header* find(BasicMemoryManager<Header>& pool, size_t size) {
+        int cls = pool.sizeClass(size);
+
+        // The class tail is its largest block
+        Header* largest = pool.m_freeTails[cls];
+        if (largest && largest->getSize() >= size) {
+            Header* current = pool.m_freeLists[cls];
+            pool.m_searchSteps++;
+            while (current->getSize() < size) {
+                current = pool.nextFree(current);
+                pool.m_searchSteps++;
+            }
+            return current;
+        }
+
+        // Smallest block of the next non-empty class
+        int larger = pool.findNonEmptyClass(cls + 1);
+        if (larger >= 0) {
+            pool.m_searchSteps++;
+            return pool.m_freeLists[larger];
+        }
+        return nullptr; // No suitable block found
+    }
+
+    template <class Header>
+    static void placed(BasicMemoryManager<Header>&, Header*) {}
+};
+
+
+// Largest free block: the tail of the highest non-empty class
+struct WorstFit {
+    static const bool kAddressOrdered = false;
+
+    static const char* getName(bool compact) {
+        return compact ? "Worst Fit (compact)" : "Worst Fit";
+    }
+
+    template <class Header>
+    static Header* find(BasicMemoryManager<Header>& pool, size_t size) {
+        int cls = pool.findLargestClass();
+        if (cls < 0) {
+            return nullptr; // No free memory at all
+        }
+
+        // The largest free block must still be large enough for the request
+        Header* worstFit = pool.m_freeTails[cls];
+        pool.m_searchSteps++;
+        if (worstFit->getSize() < size) {
+            return nullptr;
+        }
+        return worstFit;
+    }
+
+    template <class Header>
+    static void placed(BasicMemoryManager<Header>&, Header*) {}
+};
+
+
+// First fit over the block list in address order, resuming where the
+// previous allocation succeeded (the pool's rover) and wrapping around once
+struct NextFit {
+    static const bool kAddressOrdered = false; // Walks the blocks, not the classes
+
+    static const char* getName(bool compact) {
+        return compact ? "Next Fit (compact)" : "Next Fit";
+    }
+
+    template <class Header>
+    static Header* find(BasicMemoryManager<Header>& pool, size_t size) {
+        Header* current = pool.m_rover;
+        do {
+            pool.m_searchSteps++;
+            if (current->isFree() && current->getSize() >= size) {
+                return current;
+            }
+            current = nextInPool(pool, current);
+        } while (current != pool.m_rover);
+
+        return nullptr; // Every block was visited
+    }
+
+    // The next search starts right after the block just handed out
+    template <class Header>
+    static void placed(BasicMemoryManager<Header>& pool, Header* block) {
+        pool.m_rover = nextInPool(pool, block);
+    }
+
+    // Next block in address order, continuing with the first block of the
+    // next region (and the first region after the last one)
+    template <class Header>
+    static Header* nextInPool(const BasicMemoryManager<Header>& pool, Header* block) {
+        if (block->getNext()) {
+            return block->getNext();
+        }
+        size_t region = pool.findRegion(block) + 1;
+        return (Header*)pool.m_regions[region < pool.m_regions.size() ? region : 0].start;
+    }
+};
+
+
+#endif // FIT_POLICY_H
@@ -1,11 +1,29 @@
 ﻿#include "FirstFitAllocator.h"
 #include "BestFitAllocator.h"
 #include "WorstFitAllocator.h"
+#include "NextFitAllocator.h"
 #include "MemorySimulator.h"
+#include "ConcurrentAllocator.h"
+#include "SlabAllocator.h"
+#include "BuddyAllocator.h"
+#include "ArenaAllocator.h"
+#include "Benchmark.h"
+#include "TraceRecorder.h"
+#include "TraceReplayer.h"
+#include "SimulationRunner.h"
+#include "PoolAllocator.h"
 #include "Block.h"
 #include "MemoryManager.h"
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <crtdbg.h> // For memory leak detection
 
 using namespace std;
@@ -39,6 +57,8 @@ void testBlockClass() {
     b1.setNext(nullptr);
     assert(b1.getNext() == nullptr);
 
+    // Misuse is only detected by the checked accessors (debug builds)
+#if MM_CHECKED
     // Attempt to setSize with negative value (should throw exception)
     try {
         b1.setSize(-50);
@@ -66,11 +86,73 @@ void testBlockClass() {
         cout << "Caught expected exception for self-reference in setNext: " << e.what() << endl;
     }
 
+    // Sizes share a word with the flags, so they must be multiples of 8
+    try {
+        b1.setSize(30);
+        assert(false);
+    }
+    catch (const std::invalid_argument& e) {
+        cout << "Caught expected exception for unaligned size: " << e.what() << endl;
+    }
+#else
+    cout << "Block misuse checks are compiled out (MM_CHECKED=0)" << endl;
+#endif
+
     // Chain three blocks and verify the linkage
-    Block b4(10), b5(20), b6(30);
+    Block b4(8), b5(16), b6(32);
     b4.setNext(&b5);
     b5.setNext(&b6);
-    assert(b4.getNext()->getNext()->getSize() == 30);
+    assert(b4.getNext()->getNext()->getSize() == 32);
+
+    // Header layouts: 16 bytes by default, 8 bytes in compact mode
+    // (hardened builds add the requested size and a checksum)
+    assert(sizeof(Block) == (MM_HARDENED ? 32 : 16));
+    assert(sizeof(CompactBlock) == (MM_HARDENED ? 16 : 8));
+    // Compact next offsets only point forward, so the blocks share an array
+    CompactBlock compact[2] = { CompactBlock(64), CompactBlock(128) };
+    CompactBlock& c1 = compact[0];
+    CompactBlock& c2 = compact[1];
+    c1.setNext(&c2);
+    c1.setFree(false);
+    assert(c1.getNext()->getSize() == 128);
+    assert(c1.getSize() == 64 && !c1.isFree());
+
+    // Compact offsets are unsigned forward distances: a compact pool
+    // reaches just under 4 GiB
+    if (sizeof(size_t) > 4) {
+        assert(CompactBlock::getMaxSize() == ((size_t)1 << 32) - 8);
+    }
+    assert(CompactBlock::getMaxSize() % 8 == 0);
+    assert(Block::getMaxSize() >= CompactBlock::getMaxSize());
+    c2.setSize(CompactBlock::getMaxSize());
+    assert(c2.getSize() == CompactBlock::getMaxSize());
+#if MM_CHECKED
+    try {
+        c2.setNext(&c1);
+        assert(false);
+    }
+    catch (const std::invalid_argument& e) {
+        cout << "Caught expected exception for backward compact link: " << e.what() << endl;
+    }
+    try {
+        c2.setSize(CompactBlock::getMaxSize() + 8);
+        assert(false);
+    }
+    catch (const std::invalid_argument& e) {
+        cout << "Caught expected exception for oversized compact block: " << e.what() << endl;
+    }
+#endif
+
+    // The pools check their size against the layout in every build, as the
+    // unchecked accessors would silently truncate it
+    try {
+        PoolAllocator<FirstFit, CompactBlock> huge(CompactBlock::getMaxSize() + 8,
+            BackingStore(BackingStore::kMappedMemory));
+        assert(false);
+    }
+    catch (const logic_error& e) {
+        cout << "Caught expected exception for oversized compact pool: " << e.what() << endl;
+    }
 
     cout << "==== All Block Class Tests passed successfully ====\n\n";
 }
@@ -80,7 +162,7 @@ void testBlockClass() {
 void testMemoryManager() {
     cout << "==== MemoryManager class Test ====\n" << endl;
 
-    const int poolSize = 300;
+    const size_t poolSize = 304;
     FirstFitAllocator mm(poolSize);
 
     cout << "Size of Block: " << sizeof(Block) << " bytes" << endl;
@@ -155,6 +237,31 @@ void testMemoryManager() {
     catch (const out_of_range& e) {
         cout << "Caught expected exception: " << e.what() << endl;
     }
+
+    // Backward merge - freed block should join the free block before it
+    cout << "\n== Test backward merge ==" << endl;
+    void* q1 = mm.allocate(64);
+    void* q2 = mm.allocate(64);
+    assert(q1 != nullptr && q2 != nullptr);
+    mm.deallocate(q1);
+    mm.deallocate(q2);
+    assert(mm.getHeader()->isFree());
+    assert(mm.getHeader()->getNext() == nullptr);
+    assert(mm.getHeader()->getSize() + sizeof(Block) == poolSize);
+    assert(mm.getUsedMemory() == 0);
+    cout << mm << endl;
+
+    // Pointer inside the pool that is not the start of a block's data
+    void* q3 = mm.allocate(64);
+    try {
+        mm.deallocate((char*)q3 + 8);
+        assert(false); // should not get here
+    }
+    catch (const out_of_range& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+    mm.deallocate(q3);
+
     cout << "\n== Test reset with valid size ==" << endl;
     mm.reset(poolSize);
     assert(mm.getUsedMemory() == 0);
@@ -170,6 +277,54 @@ void testMemoryManager() {
     catch (const logic_error& e) {
         cout << "Caught expected exception: " << e.what() << endl;
     }
+
+    // Compact headers leave room for an allocation the default layout cannot fit
+    cout << "\n== Test compact header layout ==" << endl;
+    CompactFirstFitAllocator compact(poolSize);
+    assert(compact.getHeaderSize() == sizeof(CompactBlock));
+    assert(compact.getHeader()->getSize() + sizeof(CompactBlock) == poolSize);
+    void* c1 = compact.allocate(112);
+    void* c2 = compact.allocate(96);
+    void* c3 = compact.allocate(64);
+    assert(c1 != nullptr && c2 != nullptr && c3 != nullptr);
+    mm.reset(poolSize);
+    mm.allocate(112);
+    mm.allocate(96);
+    void* noRoom = mm.allocate(64);
+    assert(noRoom == nullptr);
+    compact.deallocate(c2);
+    compact.deallocate(c1);
+    compact.deallocate(c3);
+    assert(compact.getUsedMemory() == 0);
+    assert(compact.getHeader()->getNext() == nullptr);
+    cout << compact << endl;
+
+    // Pools and blocks larger than 2 GiB (only the headers are touched, and
+    // mapped memory only takes the pages that are touched)
+    if (sizeof(size_t) > 4) {
+        cout << "\n== Test pool larger than 2 GiB ==" << endl;
+        const size_t bigPool = (size_t)3 << 30;
+        FirstFitAllocator big(bigPool, BackingStore(BackingStore::kMappedMemory));
+        assert(big.getTotalMemory() == bigPool);
+        void* huge = big.allocate((size_t)5 << 29); // 2.5 GiB
+        assert(huge != nullptr);
+        assert(big.getUsedMemory() > ((size_t)5 << 29));
+        void* noRoom = big.allocate((size_t)1 << 30);
+        assert(noRoom == nullptr);
+        big.deallocate(huge);
+        assert(big.getUsedMemory() == 0);
+        assert(big.getHeader()->getSize() + sizeof(Block) == bigPool);
+        cout << big << endl;
+
+        // The 8-byte header reaches the same pool
+        CompactFirstFitAllocator compact(bigPool, BackingStore(BackingStore::kMappedMemory));
+        void* wide = compact.allocate((size_t)5 << 29);
+        assert(wide != nullptr);
+        compact.deallocate(wide);
+        assert(compact.getUsedMemory() == 0);
+        assert(compact.getHeader()->getSize() + sizeof(CompactBlock) == bigPool);
+    }
+
     cout << "\n==== All MemoryManager Tests Passed Successfully ====\n\n";
 }
 
@@ -220,6 +375,24 @@ void testFirstFitAllocator() {
     cout << "AFTER RESET (full pool restored)" << endl;
     cout << allocator << endl;
 
+    // First fit takes the lowest-addressed hole, best fit the tightest one
+    FirstFitAllocator firstFit(1024);
+    BestFitAllocator bestFit(1024);
+    MemoryManager* managers[] = { &firstFit, &bestFit };
+    for (int m = 0; m < 2; m++) {
+        void* wide = managers[m]->allocate(200);
+        void* pinned1 = managers[m]->allocate(40);
+        void* tight = managers[m]->allocate(64);
+        void* pinned2 = managers[m]->allocate(40);
+        managers[m]->deallocate(wide);
+        managers[m]->deallocate(tight);
+        void* picked = managers[m]->allocate(64);
+        assert(picked == (m == 0 ? wide : tight));
+        managers[m]->deallocate(picked);
+        managers[m]->deallocate(pinned1);
+        managers[m]->deallocate(pinned2);
+    }
+
     cout << "\n==== All FirstFitAllocator Tests Passed Successfully ====\n\n";
 }
 
@@ -313,7 +486,7 @@ void testWorstFitAllocator() {
     cout << allocator << endl;
 
     Block* block5 = (Block*)((char*)p5 - sizeof(Block));
-    assert(block5->getSize() == 30); // Should be from the 100 block, not the 34
+    assert(block5->getSize() == 32); // 30 rounded to the block alignment, from the 100 block
     assert(block5->isFree() == false);
 
     allocator.reset(512);
@@ -324,6 +497,1618 @@ void testWorstFitAllocator() {
 }
 
 
+// Worker for the concurrent stress test - allocates and frees small blocks
+void concurrentWorker(ConcurrentAllocator* allocator, int iterations, int seed) {
+    void* blocks[64];
+    for (int i = 0; i < iterations; i++) {
+        for (int j = 0; j < 64; j++) {
+            int size = 16 + (seed * 31 + i * 7 + j * 13) % 240;
+            blocks[j] = allocator->allocate(size);
+            assert(blocks[j] != nullptr);
+            *(int*)blocks[j] = j; // Touch the memory
+        }
+        for (int j = 0; j < 64; j++) {
+            assert(*(int*)blocks[j] == j);
+            allocator->deallocate(blocks[j]);
+        }
+    }
+    allocator->flushThreadCache();
+}
+
+
+// TEST 6 - for ConcurrentAllocator class
+void testConcurrentAllocator() {
+    cout << "==== ConcurrentAllocator class Test ====\n" << endl;
+
+    FirstFitAllocator pool(1 << 22);
+    {
+        ConcurrentAllocator allocator(pool, 16);
+
+        // Small and large allocations from one thread
+        void* small = allocator.allocate(24);
+        void* large = allocator.allocate(4096);
+        assert(small != nullptr && large != nullptr);
+        assert(pool.getUsedMemory() > 0);
+        allocator.deallocate(small);
+        allocator.deallocate(large);
+        allocator.deallocate(nullptr); // Should do nothing
+
+        // Remote free - blocks allocated by one thread, freed by another
+        vector<void*> handOff;
+        thread producer([&allocator, &handOff]() {
+            for (int i = 0; i < 100; i++) {
+                handOff.push_back(allocator.allocate(48));
+            }
+        });
+        producer.join();
+        thread consumer([&allocator, &handOff]() {
+            for (size_t i = 0; i < handOff.size(); i++) {
+                allocator.deallocate(handOff[i]);
+            }
+        });
+        consumer.join();
+        allocator.flushThreadCache();
+    }
+    // Destroying the allocator returns every cached and remotely freed block
+    assert(pool.getUsedMemory() == 0);
+    cout << "Remote frees returned to the pool" << endl;
+
+    // Stress test - throughput for an increasing number of threads
+    unsigned int cores = thread::hardware_concurrency();
+    unsigned int maxThreads = cores > 4 ? cores : 4;
+    const int iterations = 2000;
+    for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+        ConcurrentAllocator allocator(pool);
+        vector<thread> workers;
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (unsigned int t = 0; t < threads; t++) {
+            workers.push_back(thread(concurrentWorker, &allocator, iterations, (int)t));
+        }
+        for (size_t t = 0; t < workers.size(); t++) {
+            workers[t].join();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        // Every worker flushed its cache, so every block is back in the pool
+        assert(pool.getUsedMemory() == 0);
+        assert(pool.getFailedAllocations() == 0);
+
+        double ops = 2.0 * 64 * iterations * threads;
+        cout << "Threads: " << threads << "  ops/sec: " << (long long)(ops / seconds) << endl;
+    }
+    assert(pool.getUsedMemory() == 0);
+    cout << "(" << cores << " hardware threads available)" << endl;
+
+    cout << "\n==== All ConcurrentAllocator Tests Passed Successfully ====\n\n";
+}
+
+
+// TEST 7 - for SlabAllocator class
+void testSlabAllocator() {
+    cout << "==== SlabAllocator class Test ====\n" << endl;
+
+    SlabAllocator allocator(1024, 256);
+    assert(allocator.getSlabCount() == 4);
+
+    // Objects of one size are packed back to back - no per-object header
+    void* p1 = allocator.allocate(32);
+    void* p2 = allocator.allocate(30); // Rounded up to the 32-byte class
+    assert(p1 != nullptr && p2 != nullptr);
+    assert((char*)p2 - (char*)p1 == 32);
+    assert(allocator.getUsedMemory() == 64);
+    cout << "AFTER ALLOCATING 2 OBJECTS (32 bytes)" << endl;
+    cout << allocator << endl;
+
+    // Freed object is reused first (LIFO free stack)
+    allocator.deallocate(p1);
+    void* p3 = allocator.allocate(32);
+    assert(p3 == p1);
+
+    // A full slab of 32-byte objects, then a new slab for the next one
+    void* objects[8];
+    for (int i = 0; i < 6; i++) {
+        objects[i] = allocator.allocate(32);
+        assert(objects[i] != nullptr);
+    }
+    void* p4 = allocator.allocate(32);
+    assert(p4 != nullptr);
+    assert((char*)p4 - (char*)p1 == 256);
+    cout << "AFTER FILLING THE FIRST SLAB" << endl;
+    cout << allocator << endl;
+
+    // Larger than a slab - fails and is counted
+    void* tooLarge = allocator.allocate(300);
+    assert(tooLarge == nullptr);
+    assert(allocator.getFailedAllocations() == 1);
+
+    // Pointer into the middle of an object
+    try {
+        allocator.deallocate((char*)p2 + 4);
+        assert(false); // should not get here
+    }
+    catch (const out_of_range& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+
+    // Freeing an object twice is ignored - the free stack stays acyclic
+    size_t used = allocator.getUsedMemory();
+    allocator.deallocate(p2);
+    allocator.deallocate(p2);
+    assert(allocator.getUsedMemory() == used - 32);
+    void* p7 = allocator.allocate(32);
+    void* p8 = allocator.allocate(32);
+    assert(p7 == p2 && p8 != p2);
+    allocator.deallocate(p8);
+
+    // Slabs run out - one slab per size class in use
+    void* p5 = allocator.allocate(64);
+    void* p6 = allocator.allocate(128);
+    assert(p5 != nullptr && p6 != nullptr);
+    void* noSlab = allocator.allocate(16);
+    assert(noSlab == nullptr);
+
+    allocator.reset(1024);
+    assert(allocator.getUsedMemory() == 0);
+    void* afterReset = allocator.allocate(16);
+    assert(afterReset != nullptr);
+    cout << "AFTER RESET" << endl;
+    cout << allocator << endl;
+
+    cout << "\n==== All SlabAllocator Tests Passed Successfully ====\n\n";
+}
+
+
+// TEST 8 - for BuddyAllocator class
+void testBuddyAllocator() {
+    cout << "==== BuddyAllocator class Test ====\n" << endl;
+
+    BuddyAllocator allocator(1000, 16); // Arena is rounded down to 512
+    assert(allocator.getArenaSize() == 512);
+
+    // 100 bytes are served by a 128-byte block
+    void* p1 = allocator.allocate(100);
+    assert(p1 != nullptr);
+    assert(allocator.getUsedMemory() == 128);
+    assert(allocator.getInternalFragmentation() == 28);
+    cout << "AFTER ALLOCATION 1 (100 bytes)" << endl;
+    cout << allocator << endl;
+
+    // 200 bytes need a 256-byte block
+    void* p2 = allocator.allocate(200);
+    assert(p2 != nullptr);
+    assert((char*)p2 - (char*)p1 == 256);
+    assert(allocator.getInternalFragmentation() == 28 + 56);
+
+    // Only the 128-byte buddy of p1 is left
+    void* noBlock = allocator.allocate(200);
+    assert(noBlock == nullptr);
+    assert(allocator.getFailedAllocations() == 1);
+    void* p3 = allocator.allocate(128);
+    assert(p3 != nullptr);
+    assert(allocator.getInternalFragmentation() == 84);
+    cout << "AFTER ALLOCATION 3 (128 bytes - arena full)" << endl;
+    cout << allocator << endl;
+
+    // Pointer that is not the start of a block
+    try {
+        allocator.deallocate((char*)p1 + 16);
+        assert(false); // should not get here
+    }
+    catch (const out_of_range& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+
+    // Freeing everything coalesces back to a single block
+    allocator.deallocate(p2);
+    allocator.deallocate(p2); // Already free - ignored
+    allocator.deallocate(p1);
+    allocator.deallocate(p3);
+    assert(allocator.getUsedMemory() == 0);
+    assert(allocator.getInternalFragmentation() == 0);
+    assert(allocator.getPeakInternalFragmentation() == 84);
+    cout << "AFTER FREEING ALL BLOCKS" << endl;
+    cout << allocator << endl;
+
+    void* whole = allocator.allocate(512);
+    assert(whole == p1);
+
+    allocator.reset(1000);
+    assert(allocator.getUsedMemory() == 0);
+    assert(allocator.getPeakInternalFragmentation() == 0);
+
+    cout << "\n==== All BuddyAllocator Tests Passed Successfully ====\n\n";
+}
+
+
+// TEST 9 - aligned allocations (using FirstFit and BestFit)
+void testAlignedAllocation() {
+    cout << "==== Aligned Allocation Test ====\n" << endl;
+
+    FirstFitAllocator allocator(8192);
+
+    // Odd request sizes still leave every header aligned
+    void* p1 = allocator.allocate(13);
+    void* p2 = allocator.allocate(7);
+    assert(p1 != nullptr && p2 != nullptr);
+    for (const Block* b = allocator.getHeader(); b; b = b->getNext()) {
+        assert((size_t)b % 8 == 0);
+    }
+
+    // SIMD, cache-line and page alignment
+    size_t alignments[] = { 16, 32, 64, 4096 };
+    void* aligned[4];
+    for (int i = 0; i < 4; i++) {
+        aligned[i] = allocator.allocate(100, alignments[i]);
+        assert(aligned[i] != nullptr);
+        assert((size_t)aligned[i] % alignments[i] == 0);
+        Block* block = (Block*)((char*)aligned[i] - sizeof(Block));
+        assert(block->getSize() >= 100);
+        // Tail given back: what is left is too small for a free block
+        assert(block->getSize() < 104 + sizeof(Block) + 24);
+    }
+    cout << "AFTER ALIGNED ALLOCATIONS (16/32/64/4096)" << endl;
+    cout << allocator << endl;
+
+    // Invalid alignment
+    try {
+        allocator.allocate(100, 24);
+        assert(false); // should not get here
+    }
+    catch (const invalid_argument& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+
+    // Freeing everything restores a single block (padding was not lost)
+    allocator.deallocate(p1);
+    allocator.deallocate(p2);
+    for (int i = 0; i < 4; i++) {
+        allocator.deallocate(aligned[i]);
+    }
+    assert(allocator.getUsedMemory() == 0);
+    assert(allocator.getHeader()->getNext() == nullptr);
+
+    // Other strategies use the same overload
+    BestFitAllocator bestFit(1024);
+    void* p3 = bestFit.allocate(48, 64);
+    assert(p3 != nullptr && (size_t)p3 % 64 == 0);
+    bestFit.deallocate(p3);
+    assert(bestFit.getUsedMemory() == 0);
+
+    // Pools start on a page boundary, so slab and buddy blocks that are
+    // aligned inside the pool are aligned in memory too
+    SlabAllocator pageSlab(1 << 15, 4096);
+    BuddyAllocator pageBuddy(1 << 15);
+    MemoryManager* blockAligned[] = { &pageSlab, &pageBuddy };
+    for (int m = 0; m < 2; m++) {
+        void* line = blockAligned[m]->allocate(48, 64);
+        void* page = blockAligned[m]->allocate(100, 4096);
+        assert(line != nullptr && (size_t)line % 64 == 0);
+        assert(page != nullptr && (size_t)page % 4096 == 0);
+        blockAligned[m]->deallocate(line);
+        blockAligned[m]->deallocate(page);
+        assert(blockAligned[m]->getUsedMemory() == 0);
+        assert(blockAligned[m]->getFailedAllocations() == 0);
+    }
+
+    // A zero-size request is rejected before it is rounded up to the alignment
+    SlabAllocator slab(1024, 256);
+    BuddyAllocator buddy(1024);
+    try {
+        slab.allocate(0, 16);
+        assert(false);
+    }
+    catch (const invalid_argument& e) {
+        cout << "Caught expected exception (slab): " << e.what() << endl;
+    }
+    try {
+        buddy.allocate(0, 16);
+        assert(false);
+    }
+    catch (const invalid_argument& e) {
+        cout << "Caught expected exception (buddy): " << e.what() << endl;
+    }
+    assert(slab.getUsedMemory() == 0 && buddy.getUsedMemory() == 0);
+
+    cout << "\n==== All Aligned Allocation Tests Passed Successfully ====\n\n";
+}
+
+
+// TEST 10 - growable pool (using FirstFit)
+void testPoolGrowth() {
+    cout << "==== Pool Growth Test ====\n" << endl;
+
+    FirstFitAllocator allocator(256);
+
+    // Fixed pool - a request that does not fit fails
+    void* tooLarge = allocator.allocate(400);
+    assert(tooLarge == nullptr);
+    assert(allocator.getFailedAllocations() == 1);
+
+    // Growth mode - a new region is chained instead
+    allocator.enableGrowth(2.0, 4096);
+    void* p1 = allocator.allocate(400);
+    assert(p1 != nullptr);
+    assert(allocator.getRegionCount() == 2);
+    assert(allocator.getTotalMemory() > 256);
+    assert(allocator.getFailedAllocations() == 1);
+
+    // The first region is still used for requests that fit there
+    void* p2 = allocator.allocate(100);
+    assert(p2 != nullptr);
+    cout << "AFTER GROWTH (400 bytes in a new region, 100 in the first)" << endl;
+    cout << allocator << endl;
+
+    // The cap stops growth
+    void* pastCap = allocator.allocate(8192);
+    assert(pastCap == nullptr);
+    assert(allocator.getFailedAllocations() == 2);
+    assert(allocator.getTotalMemory() <= 4096);
+
+    // Pointers outside every region are still rejected
+    try {
+        int x;
+        allocator.deallocate(&x);
+        assert(false); // should not get here
+    }
+    catch (const out_of_range& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+
+    // A grown region that becomes completely free is released
+    allocator.deallocate(p1);
+    assert(allocator.getRegionCount() == 1);
+    assert(allocator.getTotalMemory() == 256);
+    allocator.deallocate(p2);
+    assert(allocator.getUsedMemory() == 0);
+
+    // Many small allocations chain several regions, all released at the end
+    vector<void*> blocks;
+    for (int i = 0; i < 40; i++) {
+        void* p = allocator.allocate(48);
+        assert(p != nullptr);
+        blocks.push_back(p);
+    }
+    assert(allocator.getRegionCount() > 2);
+    cout << "AFTER 40 ALLOCATIONS (48 bytes)" << endl;
+    cout << allocator << endl;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        allocator.deallocate(blocks[i]);
+    }
+    assert(allocator.getRegionCount() == 1);
+    assert(allocator.getUsedMemory() == 0);
+    assert(allocator.getHeader()->getNext() == nullptr);
+
+    // Reset keeps only the pool buffer
+    allocator.allocate(1000);
+    assert(allocator.getRegionCount() == 2);
+    allocator.reset(256);
+    assert(allocator.getRegionCount() == 1);
+    assert(allocator.getTotalMemory() == 256);
+
+    // A factor that would not grow the pool is rejected
+    try {
+        allocator.enableGrowth(1.0);
+        assert(false); // should not get here
+    }
+    catch (const invalid_argument& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+
+    cout << "\n==== All Pool Growth Tests Passed Successfully ====\n\n";
+}
+
+
+
+// TEST 11 - pools backed by mapped memory (using FirstFit and Buddy)
+void testBackingStore() {
+    cout << "==== Backing Store Test ====\n" << endl;
+
+    // Default allocators keep using the heap
+    FirstFitAllocator heapPool(256);
+    assert(heapPool.getBackingStore().getSource() == BackingStore::kHeap);
+
+    // Page options only make sense for mapped memory
+    try {
+        BackingStore bad(BackingStore::kHeap, BackingStore::kHugePages);
+        assert(false); // should not get here
+    }
+    catch (const invalid_argument& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+
+    // Huge pages (or transparent huge pages) with prefaulting, on node 0
+    BackingStore mapped(BackingStore::kMappedMemory,
+        BackingStore::kHugePages | BackingStore::kPrefault, 0);
+    FirstFitAllocator allocator(4096, mapped);
+    assert(allocator.getBackingStore().getSource() == BackingStore::kMappedMemory);
+    cout << "Backing store: " << allocator.getBackingStore().getName() << endl;
+
+    void* p1 = allocator.allocate(1000);
+    void* p2 = allocator.allocate(64, 64);
+    assert(p1 != nullptr && p2 != nullptr);
+    assert((size_t)p2 % 64 == 0);
+    memset(p1, 0xAB, 1000);
+
+    // Grown regions come from the same store and go back to it
+    allocator.enableGrowth(2.0);
+    void* p3 = allocator.allocate(8000);
+    assert(p3 != nullptr);
+    assert(allocator.getRegionCount() == 2);
+    memset(p3, 0xCD, 8000);
+    allocator.deallocate(p3);
+    assert(allocator.getRegionCount() == 1);
+    allocator.deallocate(p1);
+    allocator.deallocate(p2);
+    assert(allocator.getUsedMemory() == 0);
+
+    // Reset maps a new pool
+    allocator.reset(8192);
+    void* afterReset = allocator.allocate(6000);
+    assert(afterReset != nullptr);
+
+    // Other allocators take the store too
+    BuddyAllocator buddy(1024, 16, BackingStore(BackingStore::kMappedMemory));
+    void* b = buddy.allocate(100);
+    assert(b != nullptr);
+    buddy.deallocate(b);
+
+    cout << "\n==== All Backing Store Tests Passed Successfully ====\n\n";
+}
+
+
+
+// TEST 12 - returning free pages to the system (using FirstFit)
+void testTrim() {
+    cout << "==== Trim Test ====\n" << endl;
+
+    const size_t poolSize = 1 << 20;
+    BackingStore mapped(BackingStore::kMappedMemory, BackingStore::kPrefault);
+    FirstFitAllocator allocator(poolSize, mapped);
+
+    // A prefaulted pool is resident up front
+    size_t initial = allocator.getResidentMemory();
+    cout << "Resident after prefault: " << initial << " bytes" << endl;
+
+    // Touch a spike of allocations, then free it all
+    vector<void*> blocks;
+    for (int i = 0; i < 60; i++) {
+        void* p = allocator.allocate(16000);
+        assert(p != nullptr);
+        memset(p, 0x5A, 16000);
+        blocks.push_back(p);
+    }
+    for (size_t i = 0; i < blocks.size(); i++) {
+        allocator.deallocate(blocks[i]);
+    }
+    assert(allocator.getUsedMemory() == 0);
+
+    // Trimming gives back nearly the whole (now free) pool
+    size_t released = allocator.trim();
+    size_t resident = allocator.getResidentMemory();
+    cout << "Released " << released << " bytes, resident now " << resident << " bytes" << endl;
+    assert(released > poolSize - 4 * 4096);
+    assert(resident < initial / 4);
+
+    // The pool still works - trimmed pages come back as they are touched
+    void* p1 = allocator.allocate(100000);
+    assert(p1 != nullptr);
+    memset(p1, 0x11, 100000);
+    assert(allocator.getResidentMemory() >= 100000);
+
+    // Automatic trimming of large free runs on deallocate
+    allocator.setTrimThreshold(64 * 1024);
+    allocator.deallocate(p1);
+    assert(allocator.getResidentMemory() < initial / 4);
+
+    // Small free blocks have no whole page to give back
+    void* p2 = allocator.allocate(64);
+    void* p3 = allocator.allocate(64);
+    allocator.deallocate(p2);
+    assert(allocator.getHeader()->getSize() == 64);
+    allocator.deallocate(p3);
+    assert(allocator.getUsedMemory() == 0);
+
+    cout << "\n==== All Trim Tests Passed Successfully ====\n\n";
+}
+
+
+
+// TEST 13 - cheap reset and freeing everything at once
+void testReleaseAll() {
+    cout << "==== Reset and Release All Test ====\n" << endl;
+
+    // Reset to an equal or smaller size reuses the pool buffer
+    FirstFitAllocator allocator(1024);
+    const Block* buffer = allocator.getHeader();
+    allocator.allocate(100);
+    allocator.reset(1024);
+    assert(allocator.getHeader() == buffer);
+    assert(allocator.getUsedMemory() == 0);
+    allocator.reset(512);
+    assert(allocator.getHeader() == buffer);
+    assert(allocator.getTotalMemory() == 512);
+    assert(allocator.getHeader()->getSize() == 512 - sizeof(Block));
+    void* p = allocator.allocate(600);
+    assert(p == nullptr);
+
+    // A larger pool still gets a new buffer
+    allocator.reset(4096);
+    assert(allocator.getTotalMemory() == 4096);
+    p = allocator.allocate(3000);
+    assert(p != nullptr);
+
+    // releaseAll frees every allocation but keeps the peak statistics
+    allocator.reset(2048);
+    for (int i = 0; i < 10; i++) {
+        p = allocator.allocate(100);
+        assert(p != nullptr);
+    }
+    size_t peak = allocator.getPeakUsage();
+    allocator.releaseAll();
+    assert(allocator.getUsedMemory() == 0);
+    assert(allocator.getPeakUsage() == peak);
+    assert(allocator.getHeader()->isFree());
+    assert(allocator.getHeader()->getNext() == nullptr);
+    p = allocator.allocate(2048 - sizeof(Block));
+    assert(p != nullptr);
+    allocator.releaseAll();
+
+    // Grown regions stay for the next request
+    allocator.enableGrowth(2.0);
+    p = allocator.allocate(5000);
+    assert(p != nullptr);
+    size_t regions = allocator.getRegionCount();
+    assert(regions > 1);
+    allocator.releaseAll();
+    assert(allocator.getRegionCount() == regions);
+    p = allocator.allocate(5000);
+    assert(p != nullptr);
+    assert(allocator.getRegionCount() == regions);
+    allocator.releaseAll();
+    cout << "AFTER RELEASE ALL (grown pool)" << endl;
+    cout << allocator << endl;
+
+    // Slab and Buddy allocators
+    SlabAllocator slab(1024, 128);
+    for (int i = 0; i < 16; i++) {
+        p = slab.allocate(56);
+        assert(p != nullptr);
+    }
+    slab.releaseAll();
+    assert(slab.getUsedMemory() == 0);
+    for (int i = 0; i < 128; i++) {
+        p = slab.allocate(8);
+        assert(p != nullptr); // Every slab reused for a new class
+    }
+    BuddyAllocator buddy(1024);
+    p = buddy.allocate(300);
+    assert(p != nullptr);
+    p = buddy.allocate(300);
+    assert(p != nullptr);
+    buddy.releaseAll();
+    assert(buddy.getUsedMemory() == 0);
+    p = buddy.allocate(1024);
+    assert(p != nullptr);
+
+    cout << "\n==== All Reset and Release All Tests Passed Successfully ====\n\n";
+}
+
+
+
+// One request of the burst benchmark: many small objects, then drop them all
+template <class Allocator>
+static void burstRequest(Allocator& allocator, vector<void*>& blocks, int objects) {
+    for (int i = 0; i < objects; i++) {
+        blocks.push_back(allocator.allocate(32 + (i * 7) % 33)); // 32..64 bytes
+    }
+}
+
+// TEST 14 - arena (bump) allocation with marks (using ArenaAllocator)
+void testArenaAllocator() {
+    cout << "==== ArenaAllocator Test ====\n" << endl;
+
+    ArenaAllocator allocator(4096, 1024);
+    assert(allocator.getArenaSize() == 1024);
+    size_t baseUsage = allocator.getUsedMemory(); // Header of the arena block
+
+    // Objects are bumped back to back, without headers
+    char* a = (char*)allocator.allocate(10);
+    char* b = (char*)allocator.allocate(24);
+    assert(b == a + 16);
+    assert(allocator.getArenaUsed() == 40);
+    assert(allocator.getUsedMemory() == baseUsage + 40);
+
+    // Aligned objects skip to the next boundary
+    void* c = allocator.allocate(8, 64);
+    assert((size_t)c % 64 == 0);
+
+    // Rewind drops everything allocated after the mark
+    ArenaAllocator::Marker marker = allocator.mark();
+    for (int i = 0; i < 10; i++) {
+        void* object = allocator.allocate(50);
+        assert(object != nullptr);
+    }
+    allocator.rewind(marker);
+    ArenaAllocator::Marker rewound = allocator.mark();
+    assert(rewound == marker);
+    void* afterRewind = allocator.allocate(50);
+    assert(afterRewind != nullptr);
+
+    // Freeing an arena object on its own is allowed and does nothing
+    allocator.deallocate(a);
+    try {
+        allocator.rewind(allocator.getArenaSize() + 8);
+        assert(false); // should not get here
+    }
+    catch (const out_of_range& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+
+    // Once the arena is full, requests fall back to first fit
+    void* big = allocator.allocate(1000);
+    assert(big != nullptr);
+    assert((char*)big >= a + allocator.getArenaSize());
+    cout << "ARENA AFTER FALLBACK" << endl;
+    cout << allocator << endl;
+    allocator.deallocate(big);
+
+    // Rewinding to the start empties the arena
+    allocator.rewind(0);
+    assert(allocator.getUsedMemory() == baseUsage);
+    allocator.releaseAll();
+    assert(allocator.getUsedMemory() == baseUsage);
+
+    try {
+        ArenaAllocator tooLarge(512, 1024);
+        assert(false); // should not get here
+    }
+    catch (const invalid_argument& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+
+    // Burst benchmark: per request 1000 objects, freed one by one with
+    // first fit and by a single rewind with the arena
+    const int requests = 2000;
+    const int objects = 1000;
+    vector<void*> blocks;
+    blocks.reserve(objects);
+
+    FirstFitAllocator firstFit(1 << 17);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int r = 0; r < requests; r++) {
+        burstRequest(firstFit, blocks, objects);
+        for (size_t i = 0; i < blocks.size(); i++) {
+            firstFit.deallocate(blocks[i]);
+        }
+        blocks.clear();
+    }
+    double firstFitSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    assert(firstFit.getUsedMemory() == 0);
+
+    ArenaAllocator arena(1 << 17, 1 << 16);
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < requests; r++) {
+        ArenaAllocator::Marker requestStart = arena.mark();
+        burstRequest(arena, blocks, objects);
+        arena.rewind(requestStart);
+        blocks.clear();
+    }
+    double arenaSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    assert(arena.getArenaUsed() == 0);
+
+    double ops = 2.0 * requests * objects;
+    cout << "Burst requests - First Fit ops/sec: " << (long long)(ops / firstFitSeconds)
+        << "  Arena ops/sec: " << (long long)(ops / arenaSeconds) << endl;
+
+    cout << "\n==== All ArenaAllocator Tests Passed Successfully ====\n\n";
+}
+
+
+
+// TEST 15 - next fit with a roving pointer (using NextFitAllocator)
+void testNextFitAllocator() {
+    cout << "==== NextFitAllocator Test ====\n" << endl;
+
+    NextFitAllocator allocator(1024);
+
+    // Consecutive allocations continue after the previous one
+    void* a = allocator.allocate(100);
+    void* b = allocator.allocate(100);
+    void* c = allocator.allocate(100);
+    assert((char*)b > (char*)a && (char*)c > (char*)b);
+
+    // A hole before the rover is skipped while later memory fits...
+    allocator.deallocate(a);
+    void* d = allocator.allocate(100);
+    assert((char*)d > (char*)c);
+
+    // ...and used again once the search wraps around
+    void* e = allocator.allocate(500);
+    assert(e == nullptr || (char*)e > (char*)d);
+    void* f = allocator.allocate(100);
+    assert(f == a);
+
+    // The rover stays valid when the block it points to is merged away
+    allocator.deallocate(d);
+    allocator.deallocate(c);
+    allocator.deallocate(b);
+    if (e) {
+        allocator.deallocate(e);
+    }
+    void* g = allocator.allocate(600);
+    assert(g != nullptr);
+    cout << "AFTER MERGES AND A 600-BYTE ALLOCATION" << endl;
+    cout << allocator << endl;
+    allocator.deallocate(g);
+    allocator.deallocate(f);
+    assert(allocator.getUsedMemory() == 0);
+
+    // ...and after a reset
+    allocator.allocate(200);
+    allocator.reset(1024);
+    void* afterReset = allocator.allocate(1000);
+    assert(afterReset != nullptr);
+    allocator.reset(1024);
+
+    // Scan length and fragmentation against first fit: long-lived blocks
+    // stay allocated at the front while short-lived ones come and go
+    FirstFitAllocator firstFit(1 << 16);
+    NextFitAllocator nextFit(1 << 16);
+    MemoryManager* managers[] = { &firstFit, &nextFit };
+    for (int m = 0; m < 2; m++) {
+        vector<void*> shortLived;
+        for (int i = 0; i < 2000; i++) {
+            if (i % 4 == 0) {
+                managers[m]->allocate(24); // Long-lived
+            }
+            shortLived.push_back(managers[m]->allocate(16 + (i * 13) % 80));
+            if (shortLived.size() > 20) {
+                managers[m]->deallocate(shortLived.front());
+                shortLived.erase(shortLived.begin());
+            }
+        }
+        cout << managers[m]->getAlgorithmName() << ": search steps=" << managers[m]->getSearchSteps()
+            << ", fragmentation=" << managers[m]->getFragmentation() * 100 << "%" << endl;
+    }
+
+    cout << "\n==== All NextFitAllocator Tests Passed Successfully ====\n\n";
+}
+
+
+
+// TEST 16 - batch allocation and deallocation (using FirstFit)
+void testBatchAllocation() {
+    cout << "==== Batch Allocation Test ====\n" << endl;
+
+    FirstFitAllocator allocator(2048);
+    size_t sizes[] = { 40, 8, 100, 64 };
+    void* blocks[4];
+
+    // The batch is carved out of one free block, back to back
+    size_t count = allocator.allocateBatch(sizes, 4, blocks);
+    assert(count == 4);
+    assert((char*)blocks[1] == (char*)blocks[0] + 40 + sizeof(Block));
+    assert((char*)blocks[2] == (char*)blocks[1] + 24 + sizeof(Block)); // Minimum block
+    assert((char*)blocks[3] == (char*)blocks[2] + 104 + sizeof(Block));
+    assert(allocator.getUsedMemory() == 40 + 24 + 104 + 64 + 4 * sizeof(Block));
+    cout << "AFTER A BATCH OF 4" << endl;
+    cout << allocator << endl;
+
+    // Single frees still work on batch blocks
+    allocator.deallocate(blocks[1]);
+
+    // Freeing the rest as a batch leaves one free block
+    void* rest[] = { blocks[3], nullptr, blocks[0], blocks[2] };
+    allocator.deallocateBatch(rest, 4);
+    assert(allocator.getUsedMemory() == 0);
+    assert(allocator.getHeader()->isFree());
+    assert(allocator.getHeader()->getNext() == nullptr);
+
+    // Same-size batch; what does not fit in one block is allocated alone
+    void* many[40];
+    size_t allocated = allocator.allocateBatch(64, 40, many);
+    cout << "Allocated " << allocated << " of 40 blocks (64 bytes)" << endl;
+    assert(allocated == 2048 / (64 + sizeof(Block)));
+    assert(many[allocated] == nullptr);
+    assert(allocator.getFailedAllocations() == 40 - allocated);
+
+    // Interleaved frees coalesce into one block as well
+    allocator.deallocateBatch(many, 40);
+    assert(allocator.getUsedMemory() == 0);
+    assert(allocator.getHeader()->getNext() == nullptr);
+
+    // A bad pointer is reported before anything is freed
+    void* p = allocator.allocate(32);
+    int x;
+    void* bad[] = { p, &x };
+    try {
+        allocator.deallocateBatch(bad, 2);
+        assert(false); // should not get here
+    }
+    catch (const out_of_range& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+    assert(allocator.getUsedMemory() == 32 + sizeof(Block));
+    allocator.deallocate(p);
+
+    // Other allocators take batches one block at a time
+    SlabAllocator slab(1024, 128);
+    count = slab.allocateBatch(sizes, 4, blocks);
+    assert(count == 4);
+    slab.deallocateBatch(blocks, 4);
+    assert(slab.getUsedMemory() == 0);
+    ArenaAllocator arena(2048);
+    count = arena.allocateBatch(sizes, 4, blocks);
+    assert(count == 4);
+    assert(arena.getArenaUsed() == 40 + 8 + 104 + 64);
+    arena.deallocateBatch(blocks, 4);
+
+    // Burst benchmark: one request and one free per block against batches
+    const int rounds = 2000;
+    const int objects = 500;
+    vector<size_t> burstSizes(objects);
+    for (int i = 0; i < objects; i++) {
+        burstSizes[i] = 32 + (i * 7) % 33; // 32..64 bytes
+    }
+    vector<void*> burst(objects);
+    MemoryManager* pool = new FirstFitAllocator(1 << 16);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < objects; i++) {
+            burst[i] = pool->allocate(burstSizes[i]);
+        }
+        for (int i = 0; i < objects; i++) {
+            pool->deallocate(burst[i]);
+        }
+    }
+    double singleSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        count = pool->allocateBatch(burstSizes.data(), objects, burst.data());
+        assert(count == (size_t)objects);
+        pool->deallocateBatch(burst.data(), objects);
+    }
+    double batchSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    assert(pool->getUsedMemory() == 0);
+    delete pool;
+
+    double ops = 2.0 * rounds * objects;
+    cout << "Burst - single calls ops/sec: " << (long long)(ops / singleSeconds)
+        << "  batches ops/sec: " << (long long)(ops / batchSeconds) << endl;
+
+    cout << "\n==== All Batch Allocation Tests Passed Successfully ====\n\n";
+}
+
+
+
+// TEST 17 - resizing blocks in place (using FirstFit, Buddy, Slab and Arena)
+void testReallocate() {
+    cout << "==== Reallocate Test ====\n" << endl;
+
+    FirstFitAllocator allocator(1024);
+    char* a = (char*)allocator.allocate(100);
+    memset(a, 'x', 100);
+
+    // Growing into the free block that follows keeps the address
+    char* grown = (char*)allocator.reallocate(a, 400);
+    assert(grown == a);
+    assert(allocator.getUsedMemory() == 400 + sizeof(Block));
+    assert(a[0] == 'x' && a[99] == 'x');
+
+    // Shrinking splits the tail off as a free block
+    char* shrunk = (char*)allocator.reallocate(a, 50);
+    assert(shrunk == a);
+    assert(allocator.getUsedMemory() == 56 + sizeof(Block));
+
+    // A used neighbour forces a move, and the data comes along
+    char* b = (char*)allocator.allocate(64);
+    memset(a, 'y', 56);
+    char* moved = (char*)allocator.reallocate(a, 300);
+    assert(moved != a && moved != nullptr);
+    assert(moved[0] == 'y' && moved[55] == 'y');
+    cout << "AFTER GROW, SHRINK AND MOVE" << endl;
+    cout << allocator << endl;
+
+    // Not enough memory anywhere - the block stays as it was
+    void* tooLarge = allocator.reallocate(moved, 5000);
+    assert(tooLarge == nullptr);
+    assert(moved[0] == 'y');
+
+    // A null pointer is a plain allocation
+    void* c = allocator.reallocate(nullptr, 32);
+    assert(c != nullptr);
+
+    try {
+        allocator.reallocate(b, 0);
+        assert(false); // should not get here
+    }
+    catch (const invalid_argument& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+    allocator.deallocate(b);
+    try {
+        allocator.reallocate(b, 10); // Already freed
+        assert(false); // should not get here
+    }
+    catch (const out_of_range& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+    allocator.deallocate(c);
+    allocator.deallocate(moved);
+    assert(allocator.getUsedMemory() == 0);
+
+    // Buddy blocks merge with free upper buddies and split when shrinking
+    BuddyAllocator buddy(1024);
+    char* p = (char*)buddy.allocate(16);
+    memset(p, 'z', 16);
+    char* resized = (char*)buddy.reallocate(p, 200);
+    assert(resized == p);
+    assert(buddy.getUsedMemory() == 256);
+    assert(buddy.getInternalFragmentation() == 56);
+    resized = (char*)buddy.reallocate(p, 60);
+    assert(resized == p);
+    assert(buddy.getUsedMemory() == 64);
+    assert(p[15] == 'z');
+    buddy.deallocate(p);
+    assert(buddy.getUsedMemory() == 0);
+    void* whole = buddy.allocate(1024);
+    assert(whole != nullptr);
+
+    // Slab objects stay within their class and move to a larger one
+    SlabAllocator slab(1024, 128);
+    char* s = (char*)slab.allocate(10);
+    memset(s, 'q', 16);
+    resized = (char*)slab.reallocate(s, 16);
+    assert(resized == s);
+    char* s2 = (char*)slab.reallocate(s, 40);
+    assert(s2 != s && s2[15] == 'q');
+    assert(slab.getUsedMemory() == 64);
+
+    // The newest arena object is resized by moving the cursor
+    ArenaAllocator arena(2048, 1024);
+    char* o1 = (char*)arena.allocate(16);
+    char* o2 = (char*)arena.allocate(16);
+    memset(o1, 'r', 16);
+    resized = (char*)arena.reallocate(o2, 200);
+    assert(resized == o2);
+    assert(arena.getArenaUsed() == 216);
+    char* o3 = (char*)arena.reallocate(o1, 32);
+    assert(o3 == o2 + 200 && o3[15] == 'r');
+
+    cout << "\n==== All Reallocate Tests Passed Successfully ====\n\n";
+}
+
+
+// TEST 18 - handles and online compaction (using FirstFit and Arena)
+void testCompaction() {
+    cout << "==== Compaction Test ====\n" << endl;
+
+    // Eight handle blocks of 128 bytes fill the pool
+    FirstFitAllocator allocator(1024);
+    FirstFitAllocator::Handle handles[8];
+    for (int i = 0; i < 8; i++) {
+        handles[i] = allocator.allocateHandle(100);
+        assert(handles[i] != FirstFitAllocator::kNullHandle);
+        memset(allocator.resolve(handles[i]), 'a' + i, 100);
+    }
+    assert(allocator.getHandleCount() == 8);
+    FirstFitAllocator::Handle full = allocator.allocateHandle(100);
+    assert(full == FirstFitAllocator::kNullHandle);
+
+    // Every other block is freed - no hole fits 300 bytes
+    for (int i = 1; i < 8; i += 2) {
+        allocator.freeHandle(handles[i]);
+    }
+    assert(allocator.getHandleCount() == 4);
+    void* noHole = allocator.allocate(300);
+    assert(noHole == nullptr);
+    assert(allocator.getFragmentation() > 0.7);
+    cout << "BEFORE COMPACTION" << endl;
+    cout << allocator << endl;
+
+    // A small budget moves one block per call
+    bool done = allocator.compact(128);
+    assert(!done);
+    int calls = 1;
+    while (!allocator.compact(128)) {
+        calls++;
+    }
+    assert(calls >= 3);
+
+    // The live blocks are packed at the start and keep their data
+    char* base = (char*)allocator.resolve(handles[0]);
+    for (int i = 0; i < 8; i += 2) {
+        char* data = (char*)allocator.resolve(handles[i]);
+        assert(data == base + i / 2 * 128);
+        assert(data[0] == 'a' + i && data[99] == 'a' + i);
+    }
+    assert(allocator.getFragmentation() == 0.0);
+    assert(allocator.getUsedMemory() == 4 * 128);
+    cout << "AFTER COMPACTION" << endl;
+    cout << allocator << endl;
+    void* big = allocator.allocate(300);
+    assert(big != nullptr);
+    allocator.deallocate(big);
+
+    // Blocks reached through plain pointers stay, with the hole before them
+    allocator.releaseAll();
+    assert(allocator.getHandleCount() == 0);
+    FirstFitAllocator::Handle a = allocator.allocateHandle(100);
+    char* pinned = (char*)allocator.allocate(100);
+    FirstFitAllocator::Handle b = allocator.allocateHandle(100);
+    FirstFitAllocator::Handle c = allocator.allocateHandle(100);
+    memset(pinned, 'p', 100);
+    memset(allocator.resolve(c), 'c', 100);
+    char* before = (char*)allocator.resolve(c);
+    allocator.freeHandle(a);
+    allocator.freeHandle(b);
+    done = allocator.compact();
+    assert(done);
+    assert(allocator.resolve(c) == before - 128);
+    assert(pinned[0] == 'p' && before[-128] == 'c');
+    assert(allocator.getHeader()->isFree());   // The hole in front of the pinned block
+
+    // Freed handles are rejected, the null handle is ignored
+    try {
+        allocator.resolve(a);
+        assert(false); // should not get here
+    }
+    catch (const out_of_range& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+    allocator.freeHandle(FirstFitAllocator::kNullHandle);
+    allocator.freeHandle(c);
+    allocator.deallocate(pinned);
+    assert(allocator.getUsedMemory() == 0);
+
+    // Arena handles come from the first-fit part of the pool
+    ArenaAllocator arena(2048, 1024);
+    ArenaAllocator::Handle h = arena.allocateHandle(16);
+    assert(h != ArenaAllocator::kNullHandle);
+    assert(arena.getArenaUsed() == 0);
+    arena.freeHandle(h);
+
+    cout << "\n==== All Compaction Tests Passed Successfully ====\n\n";
+}
+
+
+// TEST 19 - statistics snapshot (using FirstFit and Buddy)
+void testStats() {
+    cout << "==== Stats Test ====\n" << endl;
+
+    FirstFitAllocator allocator(1024);
+    MemoryStats stats = allocator.getStats();
+    assert(stats.freeBlocks == 1 && stats.largestFreeBlock == 1024 - sizeof(Block));
+    assert(stats.externalFragmentation == 0.0 && stats.splits == 0);
+
+    void* p1 = allocator.allocate(100);
+    void* p2 = allocator.allocate(100);
+    void* p3 = allocator.allocate(100);
+    allocator.deallocate(p2);
+    allocator.deallocate(p1);   // Joins the free block left by p2
+
+    stats = allocator.getStats();
+    assert(stats.usedMemory == allocator.getUsedMemory());
+    assert(stats.freeBlocks == 2);
+    assert(stats.largestFreeBlock == 1024 - 4 * sizeof(Block) - 3 * 104);
+    assert(stats.externalFragmentation == allocator.getFragmentation());
+    assert(stats.externalFragmentation > 0.0);
+
+#if MM_STATS
+    // One split per allocation, one merge for p1 and p2
+    assert(stats.splits == 3 && stats.merges == 1);
+    assert(stats.internalWaste == 0);
+    assert(stats.allocateScans[1] == 3);       // Each search looked at one block
+    assert(stats.deallocateScans[2] == 2);     // The block and its next block
+
+    // 200 bytes leave 24 in the 224-byte hole - too little to split off
+    void* p4 = allocator.allocate(200);
+    assert(p4 == p1);
+    assert(allocator.getStats().internalWaste == 24);
+
+    // Buddy splits halve the blocks down to the request's order
+    BuddyAllocator buddy(1024);
+    void* b1 = buddy.allocate(16);
+    void* b2 = buddy.allocate(10);
+    stats = buddy.getStats();
+    assert(stats.splits == 6 && stats.internalWaste == 6);
+    assert(stats.freeBlocks == 5 && stats.largestFreeBlock == 512); // 32 to 512
+    buddy.deallocate(b1);
+    buddy.deallocate(b2);
+    stats = buddy.getStats();
+    assert(stats.merges == 6);
+    assert(stats.freeBlocks == 1 && stats.largestFreeBlock == 1024);
+    assert(stats.externalFragmentation == 0.0);
+
+    // A batch free records one scan per block, like single frees
+    FirstFitAllocator batch(1024);
+    void* run[3];
+    for (int i = 0; i < 3; i++) {
+        run[i] = batch.allocate(100);
+    }
+    batch.deallocateBatch(run, 3);
+    stats = batch.getStats();
+    assert(stats.deallocateScans[2] == 1);     // The run's first block and its next block
+    assert(stats.deallocateScans[1] == 2);     // Joined to the run directly
+
+    // A batch allocation records one scan and its waste per block: the
+    // search counts for the first block, the others are carved without one
+    batch.reset(1024);
+    size_t sizes[] = { 500, 470 };
+    void* carved[2];
+    size_t allocated = batch.allocateBatch(sizes, 2, carved);
+    assert(allocated == 2);
+    stats = batch.getStats();
+    assert(stats.allocateScans[1] == 1 && stats.allocateScans[0] == 1);
+    assert(stats.internalWaste == 16);         // Left over, kept by the last block
+
+    // Reset clears the counters
+    buddy.reset(1024);
+    assert(buddy.getStats().splits == 0);
+#endif
+    allocator.deallocate(p3);
+
+    cout << "\n==== All Stats Tests Passed Successfully ====\n\n";
+}
+
+
+// TEST 20 - timed, reproducible benchmark runs (using FirstFit)
+void testBenchmark() {
+    cout << "==== Benchmark Test ====\n" << endl;
+
+    FirstFitAllocator allocator(4096);
+    Benchmark benchmark(500, 2, 1, 7);
+    assert(benchmark.getSeed() == 7);
+
+    // The same seed gives the same workload, so the same failures
+    Benchmark::Result first = benchmark.run(&allocator, "Random Allocations");
+    Benchmark::Result second = benchmark.run(&allocator, "Random Allocations");
+    assert(first.allocate.calls == second.allocate.calls);
+    assert(first.deallocate.calls == second.deallocate.calls);
+    assert(first.failedAllocations == second.failedAllocations);
+    assert(first.peakUsage == second.peakUsage);
+    assert(first.allocate.calls > 0 && first.allocate.calls + first.deallocate.calls >= 2 * 500);
+
+    // Percentiles are ordered, and the pool is left empty
+    assert(first.allocate.p50 <= first.allocate.p99 && first.allocate.p99 <= first.allocate.p999);
+    assert(first.deallocate.p50 <= first.deallocate.p999);
+    assert(allocator.getUsedMemory() == 0);
+
+    // A pool too small for the ramps reports failures
+    vector<Benchmark::Result> results = benchmark.runAll(&allocator);
+    assert(results.size() == Benchmark::getScenarios().size());
+    assert(results[1].scenario == "Increasing Size Allocations" && results[1].failedAllocations > 0);
+    Benchmark::printTable(cout, results);
+
+    // The scenarios are the simulator's; a batch burst makes the requests
+    // of a burst in one call
+    assert(&Benchmark::getScenarios() == &MemorySimulator::getScenarios());
+    assert(results[5].scenario == "Batch Burst Allocations");
+    assert(results[5].allocate.calls == results[4].allocate.calls);
+    assert(results[5].allocate.calls == 2 * 500);
+
+    // One CSV line per result after the header, one JSON object per result
+    ostringstream csv;
+    Benchmark::writeCsv(csv, results);
+    string text = csv.str();
+    assert(count(text.begin(), text.end(), '\n') == (int)results.size() + 1);
+    assert(text.compare(0, 19, "algorithm,scenario,") == 0);
+    ostringstream json;
+    Benchmark::writeJson(json, results);
+    text = json.str();
+    assert(text[0] == '[' && count(text.begin(), text.end(), '{') == 3 * (int)results.size());
+
+    try {
+        benchmark.run(&allocator, "No Such Scenario");
+        assert(false); // should not get here
+    }
+    catch (const invalid_argument& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+
+    cout << "\n==== All Benchmark Tests Passed Successfully ====\n\n";
+}
+
+
+// TEST 21 - recording a trace and replaying it on other allocators
+void testTrace() {
+    cout << "==== Trace Test ====\n" << endl;
+
+    const char* path = "trace_test.bin";
+    {
+        BestFitAllocator allocator(4096);
+        TraceRecorder recorder(path);
+        allocator.setTraceRecorder(&recorder);
+
+        void* p1 = allocator.allocate(100);                  // id 0
+        void* p2 = allocator.allocate(200, 64);              // id 1, aligned
+        p1 = allocator.reallocate(p1, 300);                  // id 0 resized
+        void* failed = allocator.allocate(100000);           // id 2, failed
+        assert(failed == nullptr);
+        void* batch[3];
+        size_t batched = allocator.allocateBatch(32, 3, batch); // Batch of ids 3 to 5
+        assert(batched == 3);
+        BestFitAllocator::Handle handle = allocator.allocateHandle(50); // Not recorded
+        assert(handle != BestFitAllocator::kNullHandle);
+
+        // Composite calls record once and give the recorder back
+        assert(allocator.getTraceRecorder() == &recorder);
+        assert(recorder.getEventCount() == 8);
+
+        allocator.deallocateBatch(batch, 3);
+        allocator.deallocate(p2);
+        allocator.freeHandle(handle);
+        allocator.setTraceRecorder(nullptr);
+        allocator.deallocate(p1);                            // After the recording
+        assert(recorder.getEventCount() == 12);
+    }
+
+    // The same calls on another allocator of each kind
+    TraceReplayer replayer(path);
+    assert(replayer.getEventCount() == 12);
+
+    BestFitAllocator bestFit(4096);
+    TraceReplayer::Result result = replayer.replay(&bestFit);
+    assert(result.events == 12);
+    assert(result.allocations == 6 && result.reallocations == 1 && result.frees == 4);
+    assert(result.failedAllocations == 1);
+    assert(result.liveBlocks == 1);                 // p1 was freed after the recording
+    assert(result.peakUsage > 300 && bestFit.getUsedMemory() == 0);
+
+    // The pool starts on a page boundary, so the aligned block never fails here
+    BuddyAllocator buddy(4096);
+    result = replayer.replay(&buddy);
+    assert(result.events == 12 && result.failedAllocations == 1);
+    assert(buddy.getUsedMemory() == 0);
+    cout << "Replayed " << result.events << " events in " << result.seconds * 1e6
+        << " us (" << (replayer.isMapped() ? "mapped" : "streamed") << "), peak "
+        << result.peakUsage << " bytes" << endl;
+
+    // Anything but a trace is rejected
+    {
+        ofstream file(path, ios::binary | ios::trunc);
+        file << "not a trace file at all";
+    }
+    try {
+        TraceReplayer broken(path);
+        assert(false); // should not get here
+    }
+    catch (const invalid_argument& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+    remove(path);
+
+    cout << "\n==== All Trace Tests Passed Successfully ====\n\n";
+}
+
+
+// TEST 22 - the simulation matrix on several threads
+void testSimulationRunner() {
+    cout << "==== Simulation Runner Test ====\n" << endl;
+
+    SimulationRunner parallel(200, 128, 4);
+    SimulationRunner serial(200, 128, 1);
+    SimulationRunner* runners[] = { &parallel, &serial };
+    for (int i = 0; i < 2; i++) {
+        runners[i]->addAllocator([](size_t pool) { return new FirstFitAllocator(pool); });
+        runners[i]->addAllocator([](size_t pool) { return new BestFitAllocator(pool); });
+        runners[i]->addAllocator([](size_t pool) { return new BuddyAllocator(pool); });
+        runners[i]->addPoolSize(2048);
+        runners[i]->addPoolSize(8192);
+        runners[i]->addSeed(1);
+        runners[i]->addSeed(2);
+        runners[i]->addSeed(3);
+    }
+    assert(parallel.getThreadCount() == 4);
+    assert(parallel.getJobCount() == 3 * MemorySimulator::getScenarios().size() * 2 * 3);
+
+    // Results come back in matrix order, whatever the number of threads
+    vector<SimulationRunner::Result> results = parallel.run();
+    vector<SimulationRunner::Result> expected = serial.run();
+    assert(results.size() == parallel.getJobCount() && expected.size() == results.size());
+    for (size_t i = 0; i < results.size(); i++) {
+        assert(results[i].algorithm == expected[i].algorithm);
+        assert(results[i].scenario == expected[i].scenario);
+        assert(results[i].poolSize == expected[i].poolSize && results[i].seed == expected[i].seed);
+        assert(results[i].outcome.failedAllocations == expected[i].outcome.failedAllocations);
+        assert(results[i].outcome.peakUsage == expected[i].outcome.peakUsage);
+    }
+    assert(results[0].algorithm == "First Fit" && results[0].seed == 1 && results[1].seed == 2);
+    assert(results[3].poolSize == 8192);
+    assert(results.back().algorithm == "Buddy" && results.back().scenario == "Mixed Overload");
+
+    // A job is the simulator run of its seed on a fresh allocator
+    FirstFitAllocator allocator(2048);
+    MemorySimulator simulator(200, 128, 1);
+    MemorySimulator::Outcome outcome = simulator.simulate(&allocator, "Random Allocations");
+    assert(outcome.failedAllocations == results[0].outcome.failedAllocations);
+    assert(outcome.peakUsage == results[0].outcome.peakUsage);
+
+    SimulationRunner::printTable(cout, results);
+
+    try {
+        parallel.addScenario("No Such Scenario");
+        parallel.run();
+        assert(false); // should not get here
+    }
+    catch (const invalid_argument& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+
+    cout << "\n==== All Simulation Runner Tests Passed Successfully ====\n\n";
+}
+
+
+// TEST 23 - strategies composed at compile time
+void testPoolAllocator() {
+    cout << "==== Pool Allocator Test ====\n" << endl;
+
+    // The same search as the classic allocator: same blocks, same failures
+    PoolAllocator<BestFit> pool(2048);
+    BestFitAllocator classic(2048);
+    assert(string(pool.getAlgorithmName()) == classic.getAlgorithmName());
+    vector<void*> pooled;
+    vector<void*> classical;
+    for (size_t size = 8; size <= 256; size += 24) {
+        pooled.push_back(pool.allocate(size));
+        classical.push_back(classic.allocate(size));
+    }
+    for (size_t i = 0; i < pooled.size(); i += 2) {
+        pool.deallocate(pooled[i]);
+        classic.deallocate(classical[i]);
+    }
+    for (int size = 200; size > 0; size -= 48) {
+        void* a = pool.allocate(size);
+        void* b = classic.allocate(size);
+        assert((a == nullptr) == (b == nullptr));
+        assert(!a || (char*)a - (char*)pool.getHeader() == (char*)b - (char*)classic.getHeader());
+    }
+    assert(pool.getUsedMemory() == classic.getUsedMemory());
+    assert(pool.getFailedAllocations() == classic.getFailedAllocations());
+    assert(pool.getSearchSteps() == classic.getSearchSteps());
+
+    // Size classes are sorted, so best and worst fit do not scan a
+    // checkerboard of equal free blocks
+    PoolAllocator<BestFit> bestBoard(1 << 16);
+    PoolAllocator<WorstFit> worstBoard(1 << 16);
+    vector<void*> bestBlocks;
+    vector<void*> worstBlocks;
+    for (void* b; (b = bestBoard.allocate(64)) != nullptr; ) {
+        bestBlocks.push_back(b);
+    }
+    for (void* b; (b = worstBoard.allocate(64)) != nullptr; ) {
+        worstBlocks.push_back(b);
+    }
+    for (size_t i = 0; i < bestBlocks.size(); i += 2) {
+        bestBoard.deallocate(bestBlocks[i]);
+    }
+    for (size_t i = 0; i < worstBlocks.size(); i += 2) {
+        worstBoard.deallocate(worstBlocks[i]);
+    }
+    size_t steps = bestBoard.getSearchSteps();
+    void* exact = bestBoard.allocate(64);
+    void* smaller = bestBoard.allocate(40);
+    assert(exact && smaller);
+    assert(bestBoard.getSearchSteps() - steps <= 2);
+    steps = worstBoard.getSearchSteps();
+    exact = worstBoard.allocate(64);
+    smaller = worstBoard.allocate(40);
+    assert(exact && smaller);
+    assert(worstBoard.getSearchSteps() - steps <= 2);
+
+    // Still a MemoryManager - and the other policies and headers
+    PoolAllocator<NextFit, CompactBlock> compactNextFit(1024);
+    MemoryManager* manager = &compactNextFit;
+    assert(string(manager->getAlgorithmName()) == "Next Fit (compact)");
+    assert(manager->getHeaderSize() == sizeof(CompactBlock));
+    void* p = manager->allocate(100, 64);
+    assert(p && (size_t)p % 64 == 0);
+    p = manager->reallocate(p, 300);
+    assert(p);
+    manager->deallocate(p);
+    assert(manager->getUsedMemory() == 0);
+
+    PoolAllocator<WorstFit> worstFit(1024);
+    assert(string(worstFit.getAlgorithmName()) == "Worst Fit");
+    void* pinned = worstFit.allocate(64);
+    PoolAllocator<WorstFit>::Handle handle = worstFit.allocateHandle(64);
+    assert(pinned && handle != PoolAllocator<WorstFit>::kNullHandle);
+    memset(worstFit.resolve(handle), 0x5A, 64);
+    worstFit.deallocate(pinned);
+    worstFit.compact();
+    assert(((unsigned char*)worstFit.resolve(handle))[63] == 0x5A);
+    worstFit.freeHandle(handle);
+    assert(worstFit.getUsedMemory() == 0);
+
+    // The locking policy lets threads share one pool
+    PoolAllocator<FirstFit, Block, MutexLock> shared(1 << 16);
+    vector<thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.push_back(thread([&shared]() {
+            for (int i = 0; i < 500; i++) {
+                void* a = shared.allocate(16 + i % 64);
+                void* b = shared.allocate(32);
+                assert(a && b);
+                shared.deallocate(a);
+                shared.deallocate(b);
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    assert(shared.getUsedMemory() == 0);
+
+    // The inner loop can be timed either way
+    Benchmark benchmark(1000, 1, 0);
+    MemoryManager& virtualCalls = classic;
+    double virtualSeconds = benchmark.timeInnerLoop(virtualCalls);
+    double directSeconds = benchmark.timeInnerLoop(pool);
+    assert(virtualSeconds > 0 && directSeconds > 0);
+
+    try {
+        pool.allocate(0);
+        assert(false); // should not get here
+    }
+    catch (const invalid_argument& e) {
+        cout << "Caught expected exception: " << e.what() << endl;
+    }
+
+    cout << "\n==== All Pool Allocator Tests Passed Successfully ====\n\n";
+}
+
+
+// TEST 24 - hardened mode (MM_HARDENED builds)
+void testHardening() {
+    cout << "==== Hardening Test ====\n" << endl;
+
+#if MM_HARDENED
+    // Writing past the requested size hits the red zone
+    {
+        FirstFitAllocator allocator(1024);
+        char* p = (char*)allocator.allocate(40);
+        memset(p, 0x11, 40);
+        allocator.checkHeap();
+        p[40] = 0x11;
+        try {
+            allocator.checkHeap();
+            assert(false);
+        }
+        catch (const logic_error& e) {
+            cout << "Caught expected exception (checkHeap): " << e.what() << endl;
+        }
+        try {
+            allocator.deallocate(p);
+            assert(false);
+        }
+        catch (const logic_error& e) {
+            cout << "Caught expected exception for overrun: " << e.what() << endl;
+        }
+    }
+
+    // A header changed behind the pool's back no longer matches its checksum
+    {
+        BestFitAllocator allocator(1024);
+        char* a = (char*)allocator.allocate(64);
+        char* b = (char*)allocator.allocate(64);
+        assert(a && b);
+        b[-1] ^= 0x40; // Last byte of b's header
+        try {
+            allocator.deallocate(b);
+            assert(false);
+        }
+        catch (const logic_error& e) {
+            cout << "Caught expected exception for damaged header: " << e.what() << endl;
+        }
+    }
+
+    // Freed blocks are poisoned and held back; a second free is reported
+    {
+        NextFitAllocator allocator(2048);
+        unsigned char* p = (unsigned char*)allocator.allocate(48);
+        memset(p, 0x22, 48);
+        allocator.deallocate(p);
+        assert(p[0] == 0xDD && p[47] == 0xDD);
+        assert(allocator.getQuarantinedBlocks() == 1);
+        assert(allocator.getUsedMemory() == 0);
+        try {
+            allocator.deallocate(p);
+            assert(false);
+        }
+        catch (const logic_error& e) {
+            cout << "Caught expected exception for double free: " << e.what() << endl;
+        }
+
+        // Writing to the freed block is found when it leaves the quarantine
+        p[8] = 0x33;
+        try {
+            allocator.flushQuarantine();
+            assert(false);
+        }
+        catch (const logic_error& e) {
+            cout << "Caught expected exception for use after free: " << e.what() << endl;
+        }
+    }
+
+    // The quarantine is bounded, and emptied when nothing else fits
+    {
+        WorstFitAllocator allocator(1024);
+        allocator.setQuarantineLimit(2);
+        void* blocks[3];
+        for (int i = 0; i < 3; i++) {
+            blocks[i] = allocator.allocate(32);
+        }
+        for (int i = 0; i < 3; i++) {
+            allocator.deallocate(blocks[i]);
+        }
+        assert(allocator.getQuarantinedBlocks() == 2);
+        allocator.flushQuarantine();
+        assert(allocator.getQuarantinedBlocks() == 0);
+
+        allocator.setQuarantineLimit(8);
+        void* big = allocator.allocate(700);
+        assert(big);
+        allocator.deallocate(big);
+        assert(allocator.getQuarantinedBlocks() == 1);
+        big = allocator.allocate(700); // Only fits once the quarantine is flushed
+        assert(big && allocator.getQuarantinedBlocks() == 0);
+        allocator.deallocate(big);
+        allocator.flushQuarantine();
+        assert(allocator.getUsedMemory() == 0);
+        assert(allocator.getStats().freeBlocks == 1);
+    }
+
+    // Every allocation path leaves a red zone behind the data
+    {
+        FirstFitAllocator allocator(4096);
+        char* aligned = (char*)allocator.allocate(100, 64);
+        assert(aligned && (size_t)aligned % 64 == 0);
+        memset(aligned, 0x44, 100);
+        char* grown = (char*)allocator.reallocate(aligned, 300);
+        assert(grown && grown[99] == 0x44);
+        memset(grown, 0x44, 300);
+        grown = (char*)allocator.reallocate(grown, 20);
+        assert(grown[19] == 0x44);
+
+        size_t sizes[] = { 24, 40, 8 };
+        void* batch[3];
+        size_t batched = allocator.allocateBatch(sizes, 3, batch);
+        assert(batched == 3);
+        for (int i = 0; i < 3; i++) {
+            memset(batch[i], 0x55, sizes[i]);
+        }
+        FirstFitAllocator::Handle handle = allocator.allocateHandle(56);
+        memset(allocator.resolve(handle), 0x66, 56);
+        allocator.checkHeap();
+
+        allocator.deallocateBatch(batch, 3);
+        allocator.deallocate(grown);
+        allocator.compact();
+        allocator.checkHeap();
+        allocator.freeHandle(handle);
+        allocator.flushQuarantine();
+        assert(allocator.getUsedMemory() == 0);
+    }
+
+    // Arena objects stay inside the arena, before its red zone
+    {
+        ArenaAllocator arena(1024, 256);
+        char* object = (char*)arena.allocate(arena.getArenaSize());
+        memset(object, 0x77, arena.getArenaSize());
+        arena.checkHeap();
+    }
+#else
+    cout << "Hardening is compiled out (build with -DMM_HARDENED=1)" << endl;
+    assert(sizeof(Block) == 16);
+#endif
+
+    cout << "\n==== All Hardening Tests Passed Successfully ====\n\n";
+}
+
+
 
 int main(void) {
     cout << "===== RUNNING ALL TESTS =====" << endl << endl;
@@ -335,26 +2120,65 @@ int main(void) {
     try {
         // === TESTS FOR CLASSES ===
         
-        //testBlockClass();           // Test 1 Block class
-        //testMemoryManager();        // Test 2 MemoryManager class
+        // Hardened builds skip the tests that check exact block layouts and
+        // placements, which red zones and the quarantine change
+        testBlockClass();           // Test 1 Block class
+#if !MM_HARDENED
+        testMemoryManager();        // Test 2 MemoryManager class
         testFirstFitAllocator();    // Test 3 First-Fit class
+#endif
         //testBestFitAllocator();     // Test 4 Best-Fit class
+#if !MM_HARDENED
         //testWorstFitAllocator();    // Test 5 Worst-Fit class
+#endif
+        testConcurrentAllocator();  // Test 6 Concurrent front end
+        testSlabAllocator();        // Test 7 Slab class
+        testBuddyAllocator();       // Test 8 Buddy class
+#if !MM_HARDENED
+        testAlignedAllocation();    // Test 9 Aligned allocations
+        testPoolGrowth();           // Test 10 Growable pool
+        testBackingStore();         // Test 11 Mapped pool memory
+        testTrim();                 // Test 12 Returning free pages
+        testReleaseAll();           // Test 13 Cheap reset and release all
+#endif
+        testArenaAllocator();       // Test 14 Arena with marks
+#if !MM_HARDENED
+        testNextFitAllocator();     // Test 15 Next-Fit class
+        testBatchAllocation();      // Test 16 Batch allocate/deallocate
+        testReallocate();           // Test 17 In-place resize
+        testCompaction();           // Test 18 Handles and compaction
+        testStats();                // Test 19 Statistics snapshot
+#endif
+        testBenchmark();            // Test 20 Timed benchmark runs
+        testTrace();                // Test 21 Trace record and replay
+        testSimulationRunner();     // Test 22 Parallel simulation matrix
+        testPoolAllocator();        // Test 23 Compile-time strategies
+        testHardening();            // Test 24 Hardened mode
         
         
         // === SIMULATOR TEST  ===
         cout << "\n===== RUNNING MEMORY SIMULATOR =====" << endl;
 
-        const int poolSize = 2048;
+        const size_t poolSize = 2048;
 
         FirstFitAllocator firstFit(poolSize);
+        CompactFirstFitAllocator compactFirstFit(poolSize);
         BestFitAllocator bestFit(poolSize);
         WorstFitAllocator worstFit(poolSize);
+        NextFitAllocator nextFit(poolSize);
+        SlabAllocator slab(poolSize);
+        BuddyAllocator buddy(poolSize);
+        ArenaAllocator arena(poolSize);
 
         MemorySimulator simulator(100);
         simulator.runAllScenarios(&firstFit);
+        simulator.runAllScenarios(&compactFirstFit);
         simulator.runAllScenarios(&bestFit);
         simulator.runAllScenarios(&worstFit);
+        simulator.runAllScenarios(&nextFit);
+        simulator.runAllScenarios(&slab);
+        simulator.runAllScenarios(&buddy);
+        simulator.runAllScenarios(&arena);
         
 
     }
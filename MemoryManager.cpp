@@ -1,58 +1,135 @@
 #include "MemoryManager.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 using namespace std;
 
 
-// Constructor: initializes memory pool with a single free block
-MemoryManager::MemoryManager(int poolSize)
-    : m_peakUsage(0), m_totalSize(poolSize),
-    m_usedSize(0), m_failedAllocations(0) {
+// Constructor: allocates the raw memory of the pool from the backing store
+// Throws logic_error if the pool size is zero
+MemoryManager::MemoryManager(size_t poolSize, const BackingStore& backing)
+    : m_poolBuffer(nullptr), m_bufferSize(poolSize), m_backing(backing),
+    m_peakUsage(0), m_totalSize(poolSize), m_usedSize(0), m_failedAllocations(0),
+    m_searchSteps(0), m_recorder(nullptr) {
 
-    // Ensure pool size is large enough for at least one block
-    if (poolSize < sizeof(Block)) {
+    if (poolSize == 0) {
         throw logic_error("Pool size too small to initialize memory.");
     }
 
     // Allocate memory pool
-    m_memoryPool = (Block*)new char[poolSize];
-
-    // Initialize the first block as free
-    m_memoryPool->setSize(poolSize - sizeof(Block));
-    m_memoryPool->setFree(true);
-    m_memoryPool->setNext(nullptr);
+    m_poolBuffer = m_backing.acquire(poolSize);
 }
 
 // Destructor: releases the memory pool and clears pointer
 MemoryManager::~MemoryManager() {
-    delete[] m_memoryPool;
-    m_memoryPool = nullptr;
+    m_backing.release(m_poolBuffer, m_bufferSize);
+    m_poolBuffer = nullptr;
+}
+
+
+// Constructor: every statistic starts at zero
+MemoryStats::MemoryStats()
+    : usedMemory(0), freeMemory(0), peakUsage(0), failedAllocations(0),
+    freeBlocks(0), largestFreeBlock(0), externalFragmentation(0.0),
+    splits(0), merges(0), internalWaste(0) {
+    for (int i = 0; i < kScanBuckets; i++) {
+        allocateScans[i] = 0;
+        deallocateScans[i] = 0;
+    }
+}
+
+// Returns the histogram bucket of a scan: 0 for none, then one bucket per
+// power of two, the last one taking every longer scan
+int MemoryStats::scanBucket(size_t blocks) {
+    int bucket = 0;
+    while (blocks && bucket < kScanBuckets - 1) {
+        blocks >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+// Counts one call that examined 'blocks' blocks
+void MemoryManager::countScan(size_t* histogram, size_t blocks) {
+    histogram[MemoryStats::scanBucket(blocks)]++;
+}
+
+// Constructor: initializes memory pool with a single free block
+// Throws logic_error if the pool cannot hold one free block, or is larger
+// than one region of the header layout can be
+template <class Header>
+BasicMemoryManager<Header>::BasicMemoryManager(size_t poolSize, const BackingStore& backing,
+    bool addressOrdered)
+    : MemoryManager(poolSize, backing), m_compactCursor(nullptr), m_growthFactor(0),
+    m_maxPoolSize(0), m_trimThreshold(0), m_addressOrdered(addressOrdered) {
+
+    // Ensure pool size is large enough for at least one block
+    if (poolSize < sizeof(Header) + kMinPayload) {
+        throw logic_error("Pool size too small to initialize memory.");
+    }
+    // The block accessors do not check sizes in release builds
+    if (poolSize > Header::getMaxSize()) {
+        throw logic_error("Pool size too large for this header layout.");
+    }
+
+    // Start with empty lists (initPool only clears the classes in use)
+    for (int i = 0; i < kNumSizeClasses; i++) {
+        m_freeLists[i] = nullptr;
+        m_freeTails[i] = nullptr;
+    }
+    m_firstLevelMap = 0;
+    MM_HARDEN(m_quarantineLimit = kDefaultQuarantine);
+    initPool();
+}
+
+// Destructor: releases the regions added by growth
+// (the pool buffer itself is released by the base class)
+template <class Header>
+BasicMemoryManager<Header>::~BasicMemoryManager() {
+    releaseGrownRegions();
 }
 
 
 // Splits a block into two if there's enough space for a new block
 // Throws logic error if block is null
-// Throws invalid argument if size is not positive
-bool MemoryManager::splitBlock(Block* block, int size) {
+// Throws invalid argument if size is zero
+template <class Header>
+bool BasicMemoryManager<Header>::splitBlock(Header* block, size_t size) {
     if (!block) {
         throw logic_error("Cannot split: block pointer is null.");
     }
-    if (size <= 0) {
+    if (size == 0) {
         throw invalid_argument("Cannot split: requested size must be positive.");
     }
 
-    int remaining = block->getSize() - (size + sizeof(Block));
+    // Not enough space to create a new free block
+    // (sizes are unsigned, so compare before subtracting)
+    if (size > block->getSize()) {
+        return false;
+    }
 
-    // Not enough space to create a new block
-    if (remaining < sizeof(Block)) {
+    // Keep the next header aligned and big enough for the free-list links
+    size = roundRequest(size);
+    if (block->getSize() < size + sizeof(Header) + kMinPayload) {
         return false;
     }
+    size_t remaining = block->getSize() - (size + sizeof(Header));
 
-    // Calculate address for the new free block
-    Block* newBlock = (Block*)((char*)block + sizeof(Block) + size);
+    // A free block being split leaves the index
+    if (block->isFree()) {
+        removeFreeBlock(block);
+    }
 
-    // Initialize new free block
-    newBlock->setSize(remaining);
-    newBlock->setFree(true);
+    // Initialize new free block right after the requested size
+    Header* newBlock = new ((char*)block + sizeof(Header) + size) Header(remaining);
     newBlock->setNext(block->getNext());
 
     // Update current block as allocated
@@ -60,128 +137,1391 @@ bool MemoryManager::splitBlock(Block* block, int size) {
     block->setFree(false);
     block->setNext(newBlock);
 
+    // Index the new block, joining a free block that follows it
+    MM_STAT(m_stats.splits++);
+    mergeBlock(newBlock);
+    return true;
+}
+
+
+// Marks the block returned by a fit search as used and splits off the rest
+// (hardened builds keep a red zone after the 'size' bytes)
+// Returns pointer to usable memory (after block metadata)
+template <class Header>
+void* BasicMemoryManager<Header>::placeAllocation(Header* block, size_t size) {
+    MM_HARDEN(checkHeader(block));
+    removeFreeBlock(block);
+    block->setFree(false);
+
+    // Check if block can be split
+    size_t blockSize = guardSize(size);
+    if (block->getSize() >= blockSize + sizeof(Header)) {
+        splitBlock(block, blockSize);
+    }
+    MM_STAT(m_stats.internalWaste += block->getSize() - roundRequest(size));
+    MM_HARDEN(armBlock(block, size));
+
+    // Whole block is charged when no split occurred
+    m_usedSize += block->getSize() + sizeof(Header);
+
+    // Update peak memory usage if current usage exceeds previous peak
+    if (m_usedSize > m_peakUsage) {
+        m_peakUsage = m_usedSize;
+    }
+
+    return (void*)((char*)block + sizeof(Header));
+}
+
+
+// Index of the lowest / highest set bit of a non-zero mask
+static inline int lowestBit(uint64_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+static inline int highestBit(uint64_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, mask);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll(mask);
+#endif
+}
+
+// Rounds a request up to a multiple of kAlignment, at least kMinPayload
+// Blocks start at aligned addresses and have aligned sizes, so every
+// split point (and therefore every header) stays aligned
+template <class Header>
+size_t BasicMemoryManager<Header>::roundRequest(size_t size) {
+    if (size < kMinPayload) {
+        return kMinPayload;
+    }
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+// Returns true if the alignment is a positive power of two
+bool MemoryManager::isValidAlignment(size_t alignment) {
+    return alignment > 0 && (alignment & (alignment - 1)) == 0;
+}
+
+
+// Allocates memory aligned to 'alignment' using the subclass's fit strategy
+// The search asks for enough extra room to reach an aligned address with a
+// free block in front of it; that padding is given back as a free block and
+// the tail is split off again
+// Requests too large to pad without overflow fail like any other request
+// that does not fit
+// Throws invalid_argument if size is zero or alignment is invalid
+template <class Header>
+void* BasicMemoryManager<Header>::allocate(size_t size, size_t alignment) {
+    if (size == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+    if (!isValidAlignment(alignment)) {
+        throw invalid_argument("Alignment must be a power of two.");
+    }
+    TraceScope trace(this);
+    if (alignment <= kAlignment) {
+        // Every block is already aligned this much
+        return trace.allocated(size, alignment, allocate(size));
+    }
+
+    if (size > (size_t)PTRDIFF_MAX / 2 || alignment > (size_t)PTRDIFF_MAX / 2) {
+        m_failedAllocations++;
+        return trace.allocated(size, alignment, nullptr);
+    }
+
+    size_t peakBefore = m_peakUsage;
+    char* data = (char*)allocate(roundRequest(size) + alignment + sizeof(Header) + kMinPayload);
+    if (!data) {
+        return trace.allocated(size, alignment, nullptr);
+    }
+
+    Header* block = (Header*)(data - sizeof(Header));
+    m_usedSize -= block->getSize() + sizeof(Header); // Charged again below
+
+    // First aligned address that leaves room for a free block in front of it
+    size_t misalignment = (size_t)data & (alignment - 1);
+    size_t gap = misalignment ? alignment - misalignment : 0;
+    while (gap > 0 && gap < sizeof(Header) + kMinPayload) {
+        gap += alignment;
+    }
+    if (gap > 0) {
+        block = shiftBlockStart(block, gap);
+    }
+
+    // Give back whatever the over-sized search left after the data
+    splitBlock(block, guardSize(size));
+    MM_HARDEN(armBlock(block, size));
+
+    m_usedSize += block->getSize() + sizeof(Header);
+    m_peakUsage = m_usedSize > peakBefore ? m_usedSize : peakBefore;
+    return trace.allocated(size, alignment, (char*)block + sizeof(Header));
+}
+
+
+// Moves the header of a used block 'gap' bytes forward
+// The padding (at least one header and kMinPayload) becomes a free block
+// Returns the moved block
+template <class Header>
+Header* BasicMemoryManager<Header>::shiftBlockStart(Header* block, size_t gap) {
+    Header* next = block->getNext();
+    size_t newSize = block->getSize() - gap;
+
+    Header* moved = new ((char*)block + gap) Header(newSize);
+    moved->setFree(false);
+    moved->setNext(next);
+
+    // Padding becomes a free block in front of the moved one
+    // (the block came from a free block, so the one before it is used)
+    block->setSize(gap - sizeof(Header));
+    block->setFree(true);
+    block->setNext(moved);
+    insertFreeBlock(block);
+    MM_STAT(m_stats.splits++);
+    return moved;
+}
+
+
+// Returns the size class of a block
+// First level is floor(log2(size)), second level the next kSubClassBits bits
+template <class Header>
+int BasicMemoryManager<Header>::sizeClass(size_t size) {
+    if (size < (size_t)kSubClasses) {
+        return 0; // Too small to subdivide (never a free block)
+    }
+    int firstLevel = highestBit(size);
+    int subClass = (int)(size >> (firstLevel - kSubClassBits)) - kSubClasses;
+    return firstLevel * kSubClasses + subClass;
+}
+
+// Returns the first non-empty size class at or above 'cls', or -1 if none
+// Uses the bitmaps, so the cost does not depend on the number of blocks
+template <class Header>
+int BasicMemoryManager<Header>::findNonEmptyClass(int cls) const {
+    if (cls >= kNumSizeClasses) {
+        return -1;
+    }
+    int firstLevel = cls / kSubClasses;
+
+    // Remaining classes of the same power of two
+    unsigned int subMap = m_subClassMap[firstLevel] & (~0u << (cls % kSubClasses));
+    if (!subMap) {
+        // Next power of two that has any free block
+        uint64_t levelMap = firstLevel + 1 < kFirstLevels ?
+            m_firstLevelMap & (~(uint64_t)0 << (firstLevel + 1)) : 0;
+        if (!levelMap) {
+            return -1;
+        }
+        firstLevel = lowestBit(levelMap);
+        subMap = m_subClassMap[firstLevel];
+    }
+    return firstLevel * kSubClasses + lowestBit(subMap);
+}
+
+// Returns the highest non-empty size class, or -1 if there is no free block
+template <class Header>
+int BasicMemoryManager<Header>::findLargestClass() const {
+    if (!m_firstLevelMap) {
+        return -1;
+    }
+    int firstLevel = highestBit(m_firstLevelMap);
+    return firstLevel * kSubClasses + highestBit(m_subClassMap[firstLevel]);
+}
+
+// Returns the data area of a block (links of a free block live there)
+template <class Header>
+static inline void* dataOf(Header* block) {
+    return (char*)block + sizeof(Header);
+}
+
+// Returns the next free block in the same size class
+template <class Header>
+Header* BasicMemoryManager<Header>::nextFree(Header* block) {
+    return ((FreeLinks*)dataOf(block))->next;
+}
+
+// Returns the free block in front of 'block', found through its footer
+// Only valid when block->isPrevFree()
+template <class Header>
+Header* BasicMemoryManager<Header>::prevBlock(Header* block) {
+    Word prevSize = ((Word*)block)[-1];
+    return (Header*)((char*)block - prevSize - sizeof(Header));
+}
+
+// Returns true if 'block' is linked in front of 'other' in a size class
+// Size order puts a block in front of those of the same size (most
+// recently freed first)
+template <class Header>
+bool BasicMemoryManager<Header>::goesBefore(const Header* block, const Header* other) const {
+    return m_addressOrdered ? block < other : block->getSize() <= other->getSize();
+}
+
+// Links a free block into its size-class list, which is kept sorted by
+// address or by size; a block at either end of the class is linked in O(1)
+// Also writes its size footer and flags it in the following block
+template <class Header>
+void BasicMemoryManager<Header>::insertFreeBlock(Header* block) {
+    size_t size = block->getSize();
+    int cls = sizeClass(size);
+    FreeLinks* links = (FreeLinks*)dataOf(block);
+
+    ((Word*)((char*)links + size))[-1] = (Word)size;
+    if (block->getNext()) {
+        block->getNext()->setPrevFree(true);
+    }
+
+    // First block the new one goes in front of (nullptr = new tail)
+    Header* next = m_freeLists[cls];
+    if (next && !goesBefore(block, m_freeTails[cls])) {
+        next = nullptr;
+    }
+    while (next && !goesBefore(block, next)) {
+        next = nextFree(next);
+    }
+
+    links->next = next;
+    links->prev = next ? ((FreeLinks*)dataOf(next))->prev : m_freeTails[cls];
+    if (links->next) {
+        ((FreeLinks*)dataOf(links->next))->prev = block;
+    }
+    else {
+        m_freeTails[cls] = block;
+    }
+    if (links->prev) {
+        ((FreeLinks*)dataOf(links->prev))->next = block;
+    }
+    else {
+        m_freeLists[cls] = block;
+    }
+
+    // Mark the class as non-empty
+    m_subClassMap[cls / kSubClasses] |= 1u << (cls % kSubClasses);
+    m_firstLevelMap |= (uint64_t)1 << (cls / kSubClasses);
+}
+
+// Unlinks a free block from its size-class list
+template <class Header>
+void BasicMemoryManager<Header>::removeFreeBlock(Header* block) {
+    FreeLinks* links = (FreeLinks*)dataOf(block);
+
+    if (block->getNext()) {
+        block->getNext()->setPrevFree(false);
+    }
+
+    int cls = sizeClass(block->getSize());
+    if (links->next) {
+        ((FreeLinks*)dataOf(links->next))->prev = links->prev;
+    }
+    else {
+        m_freeTails[cls] = links->prev;
+    }
+    if (links->prev) {
+        ((FreeLinks*)dataOf(links->prev))->next = links->next;
+        return;
+    }
+
+    // Block was the head of its class
+    m_freeLists[cls] = links->next;
+    if (!links->next) {
+        // Class became empty - clear its bits
+        m_subClassMap[cls / kSubClasses] &= ~(1u << (cls % kSubClasses));
+        if (!m_subClassMap[cls / kSubClasses]) {
+            m_firstLevelMap &= ~((uint64_t)1 << (cls / kSubClasses));
+        }
+    }
+}
+
+// Formats the pool buffer as the only region, holding a single free block
+// The pool is cut down to a multiple of kAlignment
+template <class Header>
+void BasicMemoryManager<Header>::initPool() {
+    clearFreeIndex();
+    m_regions.clear();
+    addRegion(m_poolBuffer, m_totalSize & ~(kAlignment - 1));
+    m_memoryPool = (Header*)m_poolBuffer;
+    m_rover = m_memoryPool;
+    m_compactCursor = m_memoryPool;
+    m_handles.clear();
+    m_freeHandles.clear();
+    MM_HARDEN(m_quarantine.clear());
+}
+
+
+// Empties the free-block index
+// Only the lists of non-empty classes are touched, found through the bitmaps
+template <class Header>
+void BasicMemoryManager<Header>::clearFreeIndex() {
+    for (int level = 0; level < kFirstLevels; level++) {
+        if (m_firstLevelMap & ((uint64_t)1 << level)) {
+            for (int sub = 0; sub < kSubClasses; sub++) {
+                m_freeLists[level * kSubClasses + sub] = nullptr;
+                m_freeTails[level * kSubClasses + sub] = nullptr;
+            }
+        }
+        m_subClassMap[level] = 0;
+    }
+    m_firstLevelMap = 0;
+}
+
+
+// Turns 'size' bytes at 'start' into a region with one free block
+// The region table stays sorted by address
+template <class Header>
+void BasicMemoryManager<Header>::addRegion(char* start, size_t size) {
+    Region region = { start, start + size };
+    size_t pos = m_regions.size();
+    while (pos > 0 && m_regions[pos - 1].start > start) {
+        pos--;
+    }
+    m_regions.insert(m_regions.begin() + pos, region);
+
+    insertFreeBlock(new (start) Header(size - sizeof(Header)));
+}
+
+// Returns the index of the region containing 'ptr', or -1 if none does
+// Binary search over the sorted region table
+template <class Header>
+int BasicMemoryManager<Header>::findRegion(const void* ptr) const {
+    const char* address = (const char*)ptr;
+    size_t low = 0;
+    size_t high = m_regions.size();
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (m_regions[mid].start <= address) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    if (low == 0 || address >= m_regions[low - 1].end) {
+        return -1;
+    }
+    return (int)(low - 1);
+}
+
+
+// Adds a region big enough for a block of 'size' bytes
+// The pool grows by m_growthFactor, but never past m_maxPoolSize
+// Returns false if growth is disabled, capped, or the memory is unavailable
+template <class Header>
+bool BasicMemoryManager<Header>::growPool(size_t size) {
+    if (m_growthFactor <= 1.0 || size > (size_t)PTRDIFF_MAX / 2) {
+        return false;
+    }
+
+    size_t needed = roundRequest(size) + sizeof(Header);
+    size_t regionSize = (size_t)(m_totalSize * (m_growthFactor - 1.0));
+    if (regionSize < needed) {
+        regionSize = needed;
+    }
+    regionSize = (regionSize + kAlignment - 1) & ~(kAlignment - 1);
+
+    // Respect the cap, settling for a smaller region if the request fits
+    if (m_maxPoolSize) {
+        size_t room = m_maxPoolSize > m_totalSize ? m_maxPoolSize - m_totalSize : 0;
+        if (needed > room) {
+            return false;
+        }
+        if (regionSize > room) {
+            regionSize = room & ~(kAlignment - 1);
+        }
+    }
+
+    // A region is one block, so the header layout limits its size too
+    if (needed > Header::getMaxSize()) {
+        return false;
+    }
+    if (regionSize > Header::getMaxSize()) {
+        regionSize = Header::getMaxSize();
+    }
+
+    char* start;
+    try {
+        start = m_backing.acquire(regionSize);
+    }
+    catch (const bad_alloc&) {
+        return false; // Out of memory counts as a failed allocation
+    }
+
+    addRegion(start, regionSize);
+    m_totalSize += regionSize;
     return true;
 }
 
+// Returns a grown region to the system once its whole area is one free block
+// The pool buffer itself is never released
+template <class Header>
+void BasicMemoryManager<Header>::releaseRegion(Header* block) {
+    int index = findRegion(block);
+    Region region = m_regions[index];
+    if (region.start == m_poolBuffer || (char*)block != region.start || block->getNext()) {
+        return; // Primary region, or the region still holds used blocks
+    }
+
+    removeFreeBlock(block);
+    replaceBlock(block, m_memoryPool);
+    m_regions.erase(m_regions.begin() + index);
+    m_totalSize -= region.end - region.start;
+    m_backing.release(region.start, region.end - region.start);
+}
+
+// Frees every region added by growth (the pool buffer stays)
+template <class Header>
+void BasicMemoryManager<Header>::releaseGrownRegions() {
+    for (size_t i = 0; i < m_regions.size(); i++) {
+        if (m_regions[i].start != m_poolBuffer) {
+            m_totalSize -= m_regions[i].end - m_regions[i].start;
+            m_backing.release(m_regions[i].start, m_regions[i].end - m_regions[i].start);
+        }
+    }
+    m_regions.clear();
+}
+
+
+// Enables growth: when no block fits, a new region is chained to the pool
+// Throws invalid_argument if the factor would not grow the pool
+template <class Header>
+void BasicMemoryManager<Header>::enableGrowth(double growthFactor, size_t maxPoolSize) {
+    if (!(growthFactor > 1.0)) {
+        throw invalid_argument("Growth factor must be greater than 1.");
+    }
+    m_growthFactor = growthFactor;
+    m_maxPoolSize = maxPoolSize;
+}
+
+// Disables growth - regions already added stay until they become idle
+template <class Header>
+void BasicMemoryManager<Header>::disableGrowth() {
+    m_growthFactor = 0;
+}
+
+// Return the number of regions (1 for a pool that never grew)
+template <class Header>
+size_t BasicMemoryManager<Header>::getRegionCount() const {
+    return m_regions.size();
+}
+
+
+// Releases the pages of every free block, see purgeFreeBlock
+// Returns the number of bytes released
+template <class Header>
+size_t BasicMemoryManager<Header>::trim() {
+    size_t released = 0;
+    for (size_t r = 0; r < m_regions.size(); r++) {
+        for (Header* current = (Header*)m_regions[r].start; current; current = current->getNext()) {
+            if (current->isFree()) {
+                released += purgeFreeBlock(current);
+            }
+        }
+    }
+    return released;
+}
+
+// Sets the free block size from which deallocate trims on its own
+template <class Header>
+void BasicMemoryManager<Header>::setTrimThreshold(size_t threshold) {
+    m_trimThreshold = threshold;
+}
+
+// Releases the pages of a free block's data, keeping what the pool still
+// reads: the free-list links at the start and the size footer at the end
+// Returns the number of bytes released
+template <class Header>
+size_t BasicMemoryManager<Header>::purgeFreeBlock(Header* block) {
+    char* start = (char*)dataOf(block) + sizeof(FreeLinks);
+    char* end = (char*)dataOf(block) + block->getSize() - sizeof(Word);
+    if (end <= start) {
+        return 0;
+    }
+    return m_backing.purge(start, end - start);
+}
+
+// Return 1 - (largest free block / total free bytes) over all regions
+template <class Header>
+double BasicMemoryManager<Header>::getFragmentation() const {
+    size_t totalFree = 0;
+    size_t largestFree = 0;
+    for (size_t r = 0; r < m_regions.size(); r++) {
+        for (const Header* current = (const Header*)m_regions[r].start; current; current = current->getNext()) {
+            if (current->isFree()) {
+                totalFree += current->getSize();
+                if (current->getSize() > largestFree) {
+                    largestFree = current->getSize();
+                }
+            }
+        }
+    }
+    return totalFree ? 1.0 - (double)largestFree / totalFree : 0.0;
+}
+
+// Return the statistics of the pool, with the free blocks counted over
+// every region in one walk
+template <class Header>
+MemoryStats BasicMemoryManager<Header>::getStats() const {
+    MemoryStats stats = MemoryManager::getStats();
+    size_t totalFree = 0;
+    for (size_t r = 0; r < m_regions.size(); r++) {
+        for (const Header* current = (const Header*)m_regions[r].start; current; current = current->getNext()) {
+            if (current->isFree()) {
+                stats.freeBlocks++;
+                totalFree += current->getSize();
+                if (current->getSize() > stats.largestFreeBlock) {
+                    stats.largestFreeBlock = current->getSize();
+                }
+            }
+        }
+    }
+    stats.externalFragmentation =
+        totalFree ? 1.0 - (double)stats.largestFreeBlock / totalFree : 0.0;
+    return stats;
+}
+
+// Return the resident bytes of every region
+template <class Header>
+size_t BasicMemoryManager<Header>::getResidentMemory() const {
+    size_t resident = 0;
+    for (size_t r = 0; r < m_regions.size(); r++) {
+        resident += m_backing.residentBytes(m_regions[r].start,
+            m_regions[r].end - m_regions[r].start);
+    }
+    return resident;
+}
+
 
 // Frees a memory block at the given pointer
 // Does nothing if the pointer is null
+// Hardened builds check the block first and hold it in the quarantine
+// instead of freeing it at once
 // Throws std::out_of_range if the pointer is not part of the pool
-void MemoryManager::deallocate(void* ptr) {
+// Throws logic_error (hardened builds) on a double free or a damaged block
+template <class Header>
+void BasicMemoryManager<Header>::deallocate(void* ptr) {
 
     if (!ptr)
         return;  // Ignore null pointer (no action needed)
 
-    // Search for the block that matches the given data pointer
-    Block* current = m_memoryPool;
-    while (current != nullptr) {
+    // The header sits right in front of the data, no list walk needed
+    Header* current = blockFromPointer(ptr);
+    if (!current) {
+        throw out_of_range("Cannot deallocate: pointer does not belong to memory pool.");
+    }
 
-        // Compute the start address of the data portion in the block
-        void* dataStart = (void*)((char*)current + sizeof(Block));
+    if (!current->isFree()) {
+        MM_HARDEN(checkBlock(current));
 
-        // Match found
-        if (dataStart == ptr) {
-            if (!current->isFree()) {
-                // Update usage stats and mark block as free
-                m_usedSize -= (current->getSize() + sizeof(Block));
-                current->setFree(true);
-                mergeBlock(current); // Try to merge with following free blocks
-            }
-            return; // Either way, stop searching
+        // The block and the neighbours the merge looks at
+        MM_STAT(countScan(m_stats.deallocateScans,
+            1 + (current->getNext() ? 1 : 0) + (current->isPrevFree() ? 1 : 0)));
+
+        traceFree(ptr);
+
+        // Update usage stats and mark block as free
+        m_usedSize -= (current->getSize() + sizeof(Header));
+#if MM_HARDENED
+        quarantine(current); // Freed for real once it leaves the quarantine
+#else
+        current->setFree(true);
+        Header* merged = mergeBlock(current); // Try to merge with both free neighbours
+        afterFree(merged);
+#endif
+    }
+#if MM_HARDENED
+    else {
+        throw logic_error("Double free: block is already free.");
+    }
+#endif
+}
+
+// Resizes the block at 'ptr'
+//  - shrinking splits the tail off as a free block
+//  - growing absorbs the following block when it is free and large enough
+//  - otherwise the data moves to a new block found by the strategy
+// A null pointer is a plain allocation
+// Throws invalid_argument if the new size is zero
+// Throws std::out_of_range if the pointer is not a used block of the pool
+template <class Header>
+void* BasicMemoryManager<Header>::reallocate(void* ptr, size_t newSize) {
+    if (!ptr) {
+        return allocate(newSize);
+    }
+    if (newSize == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+    Header* block = blockFromPointer(ptr);
+    if (!block || block->isFree()) {
+        throw out_of_range("Cannot reallocate: pointer is not a used block of the memory pool.");
+    }
+    MM_HARDEN(checkBlock(block));
+    TraceScope trace(this);
+    if (newSize > (size_t)PTRDIFF_MAX / 2) {
+        m_failedAllocations++;
+        return trace.reallocated(ptr, newSize, nullptr);
+    }
+
+    size_t size = roundRequest(guardSize(newSize));
+    size_t oldSize = block->getSize();
+
+    // Grow in place by taking over the following free block
+    Header* next = block->getNext();
+    if (size > oldSize && next && next->isFree() &&
+        oldSize + sizeof(Header) + next->getSize() >= size) {
+        removeFreeBlock(next);
+        replaceBlock(next, block);
+        MM_STAT(m_stats.merges++);
+        block->setSize(oldSize + sizeof(Header) + next->getSize());
+        block->setNext(next->getNext());
+        m_usedSize += block->getSize() - oldSize;
+        oldSize = block->getSize();
+    }
+
+    // Fits now - give back what is not needed
+    if (size <= oldSize) {
+        splitBlock(block, size);
+        MM_HARDEN(armBlock(block, newSize));
+        m_usedSize -= oldSize - block->getSize();
+        if (m_usedSize > m_peakUsage) {
+            m_peakUsage = m_usedSize;
         }
+        return trace.reallocated(ptr, newSize, ptr);
+    }
+
+    // Move as a last resort
+    void* moved = allocate(newSize);
+    if (!moved) {
+        return trace.reallocated(ptr, newSize, nullptr);
+    }
+    MM_HARDEN(oldSize = block->getRequestSize()); // The red zone is not data
+    memcpy(moved, ptr, oldSize);
+    deallocate(ptr);
+    return trace.reallocated(ptr, newSize, moved);
+}
+
 
-        current = current->getNext();
+// Gives back what a deallocation left free
+template <class Header>
+void BasicMemoryManager<Header>::afterFree(Header* merged) {
+    // A large free run gives its pages back right away
+    if (m_trimThreshold && merged->getSize() >= m_trimThreshold) {
+        purgeFreeBlock(merged);
     }
 
-    // No matching block found in pool  invalid deallocation
-    throw out_of_range("Cannot deallocate: pointer does not belong to memory pool.");
+    // A grown region that became completely free goes back to the system
+    if (m_regions.size() > 1) {
+        releaseRegion(merged);
+    }
 }
 
 
-// Merges the given block with adjacent free blocks (forward only)
-// Used during deallocation to reduce fragmentation
-void MemoryManager::mergeBlock(Block* block) {
-    // Continue merging while the next block exists and is free
-    while (block && block->getNext()) {
-        Block* next = block->getNext();
-
-        // Merge current block with next if next is free
-        if (next->isFree()) {
-            int combinedSize = block->getSize() + sizeof(Block) + next->getSize();
-            block->setSize(combinedSize);
-            block->setNext(next->getNext());
-            // Stay on the same block to check the new next block
+// Allocates a batch with a single search: one block big enough for every
+// request is found by the strategy, then cut into the individual blocks
+// If no free block holds the whole batch, each block is allocated alone
+// Throws invalid_argument if any requested size is zero
+template <class Header>
+size_t BasicMemoryManager<Header>::allocateBatch(const size_t* sizes, size_t count, void** out) {
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (sizes[i] == 0) {
+            throw invalid_argument("Requested allocation size must be positive.");
         }
-        else {
-            break; // Stop merging if next block is not free
+        if (sizes[i] > (size_t)PTRDIFF_MAX / 2 || total > (size_t)PTRDIFF_MAX / 2) {
+            total = 0; // Too large to combine
+            break;
         }
+        total += roundRequest(guardSize(sizes[i])) + sizeof(Header);
+    }
+    if (count < 2 || total == 0) {
+        return MemoryManager::allocateBatch(sizes, count, out);
+    }
+
+    // The combined block is charged with one header per block of the batch
+    // Its search is the first block's scan and the waste is counted per block
+    TraceScope trace(this);
+    size_t failedBefore = m_failedAllocations;
+    MM_STAT(size_t stepsBefore = m_searchSteps);
+    MM_STAT(size_t wasteBefore = m_stats.internalWaste);
+    char* data = (char*)allocate(total - sizeof(Header));
+    if (!data) {
+        m_failedAllocations = failedBefore; // Only the single requests count
+        MM_STAT(m_stats.allocateScans[MemoryStats::scanBucket(m_searchSteps - stepsBefore)]--);
+        return trace.allocatedBatch(sizes, count, out,
+            MemoryManager::allocateBatch(sizes, count, out));
+    }
+
+    MM_STAT(m_stats.internalWaste = wasteBefore);
+    Header* block = (Header*)(data - sizeof(Header));
+    Header* after = block->getNext();
+    size_t remaining = block->getSize();
+    for (size_t i = 0; i + 1 < count; i++) {
+        size_t size = roundRequest(guardSize(sizes[i]));
+        out[i] = (char*)block + sizeof(Header);
+
+        remaining -= size + sizeof(Header);
+        Header* next = new ((char*)block + sizeof(Header) + size) Header(remaining);
+        next->setFree(false);
+        block->setSize(size);
+        block->setNext(next);
+        MM_HARDEN(armBlock(block, sizes[i]));
+        MM_STAT(m_stats.internalWaste += size - roundRequest(sizes[i]));
+        block = next;
+        MM_STAT(m_stats.splits++);
+        MM_STAT(countScan(m_stats.allocateScans, 0)); // Carved without a search
+    }
+    block->setNext(after); // The last block keeps whatever was left over
+    MM_HARDEN(armBlock(block, sizes[count - 1]));
+    MM_STAT(m_stats.internalWaste += block->getSize() - roundRequest(sizes[count - 1]));
+    out[count - 1] = (char*)block + sizeof(Header);
+    return trace.allocatedBatch(sizes, count, out, count);
+}
+
+// Frees a batch sorted by address: blocks of the batch that sit next to
+// each other are joined directly and the run is merged with its free
+// neighbours once
+// Every pointer is checked before anything is freed
+// Hardened builds free the blocks one by one, so each is checked and
+// goes through the quarantine
+// Throws std::out_of_range if a pointer is not part of the pool
+template <class Header>
+void BasicMemoryManager<Header>::deallocateBatch(void* const* ptrs, size_t count) {
+#if MM_HARDENED
+    MemoryManager::deallocateBatch(ptrs, count);
+#else
+    vector<Header*> blocks;
+    blocks.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (!ptrs[i]) {
+            continue;
+        }
+        Header* block = blockFromPointer(ptrs[i]);
+        if (!block) {
+            throw out_of_range("Cannot deallocate: pointer does not belong to memory pool.");
+        }
+        if (!block->isFree()) {
+            blocks.push_back(block); // Already free blocks are ignored, as in deallocate
+        }
+    }
+    sort(blocks.begin(), blocks.end(), less<Header*>());
+    blocks.erase(unique(blocks.begin(), blocks.end()), blocks.end());
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        Header* run = blocks[i];
+
+        // The first block of a run and the neighbours the merge looks at,
+        // as in deallocate; blocks joined to the run only examine themselves
+        MM_STAT(countScan(m_stats.deallocateScans,
+            1 + (run->getNext() ? 1 : 0) + (run->isPrevFree() ? 1 : 0)));
+
+        traceFree((char*)run + sizeof(Header));
+        m_usedSize -= run->getSize() + sizeof(Header);
+        run->setFree(true);
+
+        // Absorb the following blocks of the batch while they are adjacent
+        while (i + 1 < blocks.size() && blocks[i + 1] == run->getNext()) {
+            Header* next = blocks[++i];
+            MM_STAT(countScan(m_stats.deallocateScans, 1));
+            traceFree((char*)next + sizeof(Header));
+            m_usedSize -= next->getSize() + sizeof(Header);
+            run->setSize(run->getSize() + sizeof(Header) + next->getSize());
+            run->setNext(next->getNext());
+            replaceBlock(next, run);
+            MM_STAT(m_stats.merges++);
+        }
+
+        afterFree(mergeBlock(run));
+    }
+#endif
+}
+
+
+// Returns the block whose data portion starts at 'ptr'
+// Returns nullptr if 'ptr' is outside the pool or not preceded by a valid header
+template <class Header>
+Header* BasicMemoryManager<Header>::blockFromPointer(void* ptr) const {
+    char* data = (char*)ptr;
+
+    // Range check - the data must lie inside a region, behind a header
+    int index = findRegion(data);
+    if (index < 0 || data < m_regions[index].start + sizeof(Header)) {
+        return nullptr;
+    }
+
+    Header* block = (Header*)(data - sizeof(Header));
+    return isValidHeader(block, m_regions[index]) ? block : nullptr;
+}
+
+
+// Checks that a header inside the pool is consistent with its neighbours
+// Blocks are contiguous, so the next offset must match the physical layout,
+// the flags must agree with the next block and a free previous block must
+// match its footer
+template <class Header>
+bool BasicMemoryManager<Header>::isValidHeader(const Header* block,
+    const Region& region) const {
+    typedef typename Header::Offset Offset;
+    const char* poolStart = region.start;
+    const char* poolEnd = region.end;
+    const char* blockStart = (const char*)block;
+
+    // Headers are aligned and the block must end inside its region
+    size_t size = block->getSize();
+    if ((size_t)(blockStart - poolStart) % kAlignment != 0 ||
+        size > (size_t)(poolEnd - blockStart) - sizeof(Header)) {
+        return false;
+    }
+    const char* blockEnd = blockStart + sizeof(Header) + size;
+
+    // The next offset must lead right after this block (or be 0 at the end)
+    Offset offset = (Offset)block->m_nextOffset;
+    if (offset ? offset != blockEnd - blockStart : blockEnd != poolEnd) {
+        return false;
+    }
+    if (offset && block->getNext()->isPrevFree() != block->isFree()) {
+        return false;
+    }
+
+    // Only a free previous block can be checked, through its footer
+    if (!block->isPrevFree()) {
+        return true;
+    }
+    if (blockStart == poolStart) {
+        return false;
+    }
+    Word prevSize = ((const Word*)block)[-1];
+    if (prevSize % kAlignment != 0 ||
+        prevSize + sizeof(Header) > (size_t)(blockStart - poolStart)) {
+        return false;
+    }
+    const Header* prev = (const Header*)(blockStart - prevSize - sizeof(Header));
+    return prev->isFree() && (Word)prev->getSize() == prevSize &&
+        (Offset)prev->m_nextOffset == (Offset)(prevSize + sizeof(Header));
+}
+
+
+// Merges the given block with its free neighbours (both directions)
+// Used during deallocation to reduce fragmentation
+// Adjacent free blocks are always merged, so one step on each side is enough
+// Returns the block that owns the merged region
+template <class Header>
+Header* BasicMemoryManager<Header>::mergeBlock(Header* block) {
+    if (!block) {
+        return nullptr;
+    }
+
+    // Absorb the following block if it is free
+    Header* next = block->getNext();
+    MM_HARDEN(if (next) checkHeader(next));
+    if (next && next->isFree()) {
+        removeFreeBlock(next);
+        size_t combinedSize = block->getSize() + sizeof(Header) + next->getSize();
+        block->setSize(combinedSize);
+        block->setNext(next->getNext());
+        replaceBlock(next, block); // Nothing may point into a merged block
+        MM_STAT(m_stats.merges++);
+    }
+
+    // Let the preceding block absorb this one if it is free
+    if (block->isPrevFree()) {
+        Header* prev = prevBlock(block);
+        MM_HARDEN(checkHeader(prev));
+        removeFreeBlock(prev);
+        size_t combinedSize = prev->getSize() + sizeof(Header) + block->getSize();
+        prev->setSize(combinedSize);
+        prev->setNext(block->getNext());
+        replaceBlock(block, prev);
+        MM_STAT(m_stats.merges++);
+        block = prev;
+    }
+
+    insertFreeBlock(block);
+    return block;
+}
+
+// Points the next-fit rover and the compaction cursor at 'block' when they
+// were at 'old', a header that is about to disappear
+template <class Header>
+void BasicMemoryManager<Header>::replaceBlock(Header* old, Header* block) {
+    if (m_rover == old) {
+        m_rover = block;
+    }
+    if (m_compactCursor == old) {
+        m_compactCursor = block;
     }
 }
 
 
 // Return total memory size
-int MemoryManager::getTotalMemory() const {
+size_t MemoryManager::getTotalMemory() const {
     return m_totalSize;
 }
 
 // Return memory currently in use
-int MemoryManager::getUsedMemory() const {
+size_t MemoryManager::getUsedMemory() const {
     return m_usedSize;
 }
 
 // Return amount of free memory
-int MemoryManager::getFreeMemory() const {
+size_t MemoryManager::getFreeMemory() const {
     return m_totalSize - m_usedSize;
 }
 
 // Return peak memory usage
-int MemoryManager::getPeakUsage() const {
+size_t MemoryManager::getPeakUsage() const {
     return m_peakUsage;
 }
 
 // Return number of failed allocations
-int MemoryManager::getFailedAllocations() const {
+size_t MemoryManager::getFailedAllocations() const {
     return m_failedAllocations;
 }
 
+// Allocates every block of a batch on its own
+// Throws invalid_argument if any requested size is zero
+size_t MemoryManager::allocateBatch(const size_t* sizes, size_t count, void** out) {
+    for (size_t i = 0; i < count; i++) {
+        if (sizes[i] == 0) {
+            throw invalid_argument("Requested allocation size must be positive.");
+        }
+    }
+
+    TraceScope trace(this);
+    size_t allocated = 0;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = allocate(sizes[i]);
+        if (out[i]) {
+            allocated++;
+        }
+    }
+    return trace.allocatedBatch(sizes, count, out, allocated);
+}
+
+// Allocates 'count' blocks of 'size' bytes
+size_t MemoryManager::allocateBatch(size_t size, size_t count, void** out) {
+    vector<size_t> sizes(count, size);
+    return allocateBatch(sizes.data(), count, out);
+}
+
+// Frees every pointer of a batch on its own
+void MemoryManager::deallocateBatch(void* const* ptrs, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (ptrs[i]) {
+            deallocate(ptrs[i]);
+        }
+    }
+}
+
+
+// Return the number of blocks examined by allocation searches
+size_t MemoryManager::getSearchSteps() const {
+    return m_searchSteps;
+}
+
+// Return the external fragmentation of the free memory, from 0 (one free
+// block) towards 1 (many small pieces); 0 for allocators that do not track it
+double MemoryManager::getFragmentation() const {
+    return 0.0;
+}
+
+// Return the usage statistics and the MM_STATS counters
+// Free-block figures are left to allocators that keep free blocks
+MemoryStats MemoryManager::getStats() const {
+    MemoryStats stats = m_stats;
+    stats.usedMemory = m_usedSize;
+    stats.freeMemory = m_totalSize - m_usedSize;
+    stats.peakUsage = m_peakUsage;
+    stats.failedAllocations = m_failedAllocations;
+    stats.externalFragmentation = getFragmentation();
+    return stats;
+}
+
+// Return the metadata bytes in front of every block (none by default)
+size_t MemoryManager::getHeaderSize() const {
+    return 0;
+}
+
+// Return the bytes of the pool buffer backed by physical memory
+size_t MemoryManager::getResidentMemory() const {
+    return m_backing.residentBytes(m_poolBuffer, m_totalSize);
+}
+
+// Return the source of the pool memory
+const BackingStore& MemoryManager::getBackingStore() const {
+    return m_backing;
+}
+
+// Attach a trace recorder (nullptr detaches it)
+void MemoryManager::setTraceRecorder(TraceRecorder* recorder) {
+    m_recorder = recorder;
+}
+
+// Return the attached trace recorder (nullptr if none)
+TraceRecorder* MemoryManager::getTraceRecorder() const {
+    return m_recorder;
+}
+
 // Return pointer to the first block (read-only)
-const Block* MemoryManager::getHeader() const {
+template <class Header>
+const Header* BasicMemoryManager<Header>::getHeader() const {
     return m_memoryPool;
 }
 
-// Return name of the memory allocation algorithm
-const char* MemoryManager::getAlgorithmName() const {
-    return "BaseMemoryManager"; // Default 
+// Return the size of the block header layout
+template <class Header>
+size_t BasicMemoryManager<Header>::getHeaderSize() const {
+    return sizeof(Header);
 }
 
 // Reset the memory pool with a new size, clearing all state and data
-// Throws "invalid_argument" if the pool size is too small
-void MemoryManager::reset(int poolSize) {
-    if (poolSize < (int)sizeof(Block)) {
-        throw logic_error("Reset failed: pool size too small to hold a block.");
+// A buffer at least as large as the new pool is kept, otherwise the
+// buffer is released and a larger one is acquired
+// Throws logic_error if the pool size is zero
+void MemoryManager::reset(size_t poolSize) {
+    if (poolSize == 0) {
+        throw logic_error("Reset failed: pool size must be positive.");
     }
 
-    // Free previously allocated memory
-    delete[] m_memoryPool;
-    m_memoryPool = nullptr;
+    // Replace the buffer only when the pool no longer fits in it
+    if (poolSize > m_bufferSize) {
+        m_backing.release(m_poolBuffer, m_bufferSize);
+        m_poolBuffer = nullptr;
+        m_bufferSize = 0;
+
+        m_poolBuffer = m_backing.acquire(poolSize);
+        m_bufferSize = poolSize;
+    }
 
     // Reset usage statistics
     m_totalSize = poolSize;
     m_usedSize = 0;
     m_peakUsage = 0;
     m_failedAllocations = 0;
+    m_searchSteps = 0;
+    m_stats = MemoryStats();
+}
+
+// Reset the pool and format it as a single free block
+// Throws logic_error if the pool size is too small to hold a block or too
+// large for the header layout
+template <class Header>
+void BasicMemoryManager<Header>::reset(size_t poolSize) {
+    if (poolSize < sizeof(Header) + kMinPayload) {
+        throw logic_error("Reset failed: pool size too small to hold a block.");
+    }
+    if (poolSize > Header::getMaxSize()) {
+        throw logic_error("Reset failed: pool size too large for this header layout.");
+    }
+    releaseGrownRegions();
+    MemoryManager::reset(poolSize);
+    initPool();
+}
+
+// Frees every allocation in one pass over the regions: each region is
+// formatted again as a single free block
+// Grown regions are kept, so the next burst of allocations does not have
+// to grow the pool again
+template <class Header>
+void BasicMemoryManager<Header>::releaseAll() {
+    clearFreeIndex();
+    for (size_t r = 0; r < m_regions.size(); r++) {
+        size_t size = m_regions[r].end - m_regions[r].start;
+        insertFreeBlock(new (m_regions[r].start) Header(size - sizeof(Header)));
+    }
+    m_rover = m_memoryPool;
+    m_compactCursor = m_memoryPool;
+    m_handles.clear();
+    m_freeHandles.clear();
+    MM_HARDEN(m_quarantine.clear());
+    m_usedSize = 0;
+}
+
+
+// Allocates a block with the subclass's strategy and gives it a handle
+// The block holds the handle's slot number in front of the data
+// Throws invalid_argument if size is zero
+template <class Header>
+typename BasicMemoryManager<Header>::Handle BasicMemoryManager<Header>::allocateHandle(size_t size) {
+    if (size == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+    if (size > (size_t)PTRDIFF_MAX / 2) {
+        m_failedAllocations++;
+        return kNullHandle;
+    }
+    TraceScope trace(this); // Compaction moves the block, so it is left out
+    return registerHandle(allocate(size + kHandleSlotSize));
+}
+
+// Records a freshly allocated block in the handle table and marks it movable
+// Returns kNullHandle if the allocation failed
+template <class Header>
+typename BasicMemoryManager<Header>::Handle BasicMemoryManager<Header>::registerHandle(void* data) {
+    if (!data) {
+        return kNullHandle;
+    }
+    Header* block = (Header*)((char*)data - sizeof(Header));
+
+    size_t slot;
+    if (!m_freeHandles.empty()) {
+        slot = m_freeHandles.back();
+        m_freeHandles.pop_back();
+        m_handles[slot] = block;
+    }
+    else {
+        slot = m_handles.size();
+        m_handles.push_back(block);
+    }
+    *(size_t*)data = slot;
+    block->setMovable(true);
+    return slot + 1; // Handle 0 is kNullHandle
+}
+
+// Returns the block of a live handle
+// Throws std::out_of_range if the handle was never given out or is freed
+template <class Header>
+Header* BasicMemoryManager<Header>::handleBlock(Handle handle) const {
+    if (handle == kNullHandle || handle > m_handles.size() || !m_handles[handle - 1]) {
+        throw out_of_range("Handle is not live in this memory pool.");
+    }
+    return m_handles[handle - 1];
+}
+
+// Returns the current address of a handle's data
+// Throws std::out_of_range if the handle is not live
+template <class Header>
+void* BasicMemoryManager<Header>::resolve(Handle handle) const {
+    return (char*)handleBlock(handle) + sizeof(Header) + kHandleSlotSize;
+}
+
+// Frees the block of a handle; its slot is reused by the next handle
+// Does nothing if the handle is null
+// Throws std::out_of_range if the handle is not live
+template <class Header>
+void BasicMemoryManager<Header>::freeHandle(Handle handle) {
+    if (handle == kNullHandle) {
+        return;
+    }
+    Header* block = handleBlock(handle);
+    block->setMovable(false);
+    m_handles[handle - 1] = nullptr;
+    m_freeHandles.push_back(handle - 1);
+    TraceScope trace(this);
+    deallocate((char*)block + sizeof(Header));
+}
+
+// Return the number of live handles
+template <class Header>
+size_t BasicMemoryManager<Header>::getHandleCount() const {
+    return m_handles.size() - m_freeHandles.size();
+}
+
+
+// Walks the pool from the compaction cursor and slides every movable block
+// that follows a free block down over it; the free space moves up and joins
+// the free blocks after it, until each region ends in one free block
+// Blocks that are not movable (plain pointers) stay, and the free block in
+// front of them remains
+// The work is bounded by 'maxBytes' (0 = no limit): moving a block costs
+// its size, stepping over one costs a header
+// Returns true when the pass reached the end of the pool (the next call
+// starts over), false when the budget ran out first
+template <class Header>
+bool BasicMemoryManager<Header>::compact(size_t maxBytes) {
+    size_t region = findRegion(m_compactCursor);
+    Header* current = m_compactCursor;
+    size_t work = 0;
+
+    while (!maxBytes || work < maxBytes) {
+        Header* next = current->getNext();
+        if (!next) {
+            // End of a region - go on with the next one or finish the pass
+            if (++region == m_regions.size()) {
+                m_compactCursor = (Header*)m_regions[0].start;
+                return true;
+            }
+            current = (Header*)m_regions[region].start;
+        }
+        else if (current->isFree() && next->isMovable()) {
+            work += sizeof(Header) + next->getSize();
+            current = slideBlock(current, next);
+            continue;
+        }
+        else {
+            current = next;
+        }
+        work += sizeof(Header);
+    }
+
+    m_compactCursor = current;
+    return false;
+}
+
+// Moves 'block' (header and data) to the start of the free block 'hole'
+// right in front of it; the free space now lies behind the block and is
+// merged with the block that follows
+// The block's handle is pointed at the new address
+// Returns the free block behind the moved block
+template <class Header>
+Header* BasicMemoryManager<Header>::slideBlock(Header* hole, Header* block) {
+    size_t gap = hole->getSize();
+    Header* after = block->getNext();
+    removeFreeBlock(hole);
+
+    memmove(hole, block, sizeof(Header) + block->getSize());
+    Header* moved = hole;
+    moved->setPrevFree(false); // The block in front of the hole is used
+
+    Header* freed = new ((char*)dataOf(moved) + moved->getSize()) Header(gap);
+    freed->setNext(after);
+    moved->setNext(freed);
+    replaceBlock(block, moved);
+    m_handles[*(size_t*)dataOf(moved)] = moved;
+
+    Header* merged = mergeBlock(freed);
+    afterFree(merged);
+    return merged;
+}
+
+#if MM_HARDENED
+
+// ---- Hardening ---- //
+
+// Returns true if the data of 'block' holds 'byte' from offset 'from' to its end
+template <class Header>
+static bool isFilled(const Header* block, size_t from, unsigned char byte) {
+    const unsigned char* data = (const unsigned char*)block + sizeof(Header);
+    for (size_t i = from; i < block->getSize(); i++) {
+        if (data[i] != byte) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Records the size asked for and fills the rest of the block's data (the
+// red zone, at least kRedZoneSize bytes) with a known pattern
+template <class Header>
+void BasicMemoryManager<Header>::armBlock(Header* block, size_t size) {
+    block->setRequestSize(size);
+    memset((char*)dataOf(block) + size, kRedZoneByte, block->getSize() - size);
+}
+
+// Throws logic_error if 'block' lies outside the pool or its header no
+// longer matches its checksum
+template <class Header>
+void BasicMemoryManager<Header>::checkHeader(const Header* block) const {
+    if (findRegion(block) < 0 || !block->isIntact()) {
+        throw logic_error("Heap corruption: block header was overwritten.");
+    }
+}
+
+// Checks a used block the caller hands back: its header, that it was not
+// freed already (held in the quarantine), that nothing was written past
+// the requested size and that the header after it is intact
+// Throws logic_error at the first problem
+template <class Header>
+void BasicMemoryManager<Header>::checkBlock(const Header* block) const {
+    checkHeader(block);
+    if (isQuarantined(block)) {
+        throw logic_error("Double free: block is already free.");
+    }
+    if (!isFilled(block, block->getRequestSize(), kRedZoneByte)) {
+        throw logic_error("Heap corruption: data written past the end of a block.");
+    }
+    if (block->getNext()) {
+        checkHeader(block->getNext());
+    }
+}
+
+// Returns true if the block is held in the quarantine
+template <class Header>
+bool BasicMemoryManager<Header>::isQuarantined(const Header* block) const {
+    return find(m_quarantine.begin(), m_quarantine.end(), block) != m_quarantine.end();
+}
+
+// Poisons the data of a freed block and holds the block back, so a stale
+// pointer reads garbage and the block is not handed out again right away
+// The oldest held block is freed once the quarantine is over its limit
+template <class Header>
+void BasicMemoryManager<Header>::quarantine(Header* block) {
+    memset(dataOf(block), kFreedByte, block->getSize());
+    m_quarantine.push_back(block);
+    while (m_quarantine.size() > m_quarantineLimit) {
+        releaseQuarantined();
+    }
+}
+
+// Frees the oldest held block for real
+// Throws logic_error if it was written to while it was held
+template <class Header>
+void BasicMemoryManager<Header>::releaseQuarantined() {
+    Header* block = m_quarantine.front();
+    checkHeader(block);
+    if (!isFilled(block, 0, kFreedByte)) {
+        throw logic_error("Use after free: a freed block was written to.");
+    }
+    m_quarantine.pop_front();
 
-    // Allocate new memory pool
-    char* pool = new char[poolSize];
-    m_memoryPool = (Block*)pool;
+    block->setFree(true);
+    afterFree(mergeBlock(block));
+}
+
+// Sets the number of freed blocks held back (0 frees them at once)
+// Throws logic_error if a block released now was written to
+template <class Header>
+void BasicMemoryManager<Header>::setQuarantineLimit(size_t maxBlocks) {
+    m_quarantineLimit = maxBlocks;
+    while (m_quarantine.size() > m_quarantineLimit) {
+        releaseQuarantined();
+    }
+}
 
-    // Initialize first block as free
-    int usableSize = poolSize - sizeof(Block);
-    m_memoryPool->setSize(usableSize);
-    m_memoryPool->setFree(true);
-    m_memoryPool->setNext(nullptr);
+// Return the number of freed blocks held back
+template <class Header>
+size_t BasicMemoryManager<Header>::getQuarantinedBlocks() const {
+    return m_quarantine.size();
+}
+
+// Frees every held block, oldest first
+// Throws logic_error if one was written to while it was held
+template <class Header>
+void BasicMemoryManager<Header>::flushQuarantine() {
+    while (!m_quarantine.empty()) {
+        releaseQuarantined();
+    }
 }
 
+// Walks every region: all headers must match their checksums, used blocks
+// their red zones and held blocks their poison
+// Throws logic_error at the first damaged block
+template <class Header>
+void BasicMemoryManager<Header>::checkHeap() const {
+    for (size_t r = 0; r < m_regions.size(); r++) {
+        for (const Header* current = (const Header*)m_regions[r].start; current; current = current->getNext()) {
+            checkHeader(current);
+            if (current->isFree()) {
+                continue;
+            }
+            if (isQuarantined(current)) {
+                if (!isFilled(current, 0, kFreedByte)) {
+                    throw logic_error("Use after free: a freed block was written to.");
+                }
+            }
+            else if (!isFilled(current, current->getRequestSize(), kRedZoneByte)) {
+                throw logic_error("Heap corruption: data written past the end of a block.");
+            }
+        }
+    }
+}
+
+#endif // MM_HARDENED
+
+
 // Output memory manager status and block list
 ostream& operator<<(ostream& os, const MemoryManager& mm) {
     // General memory usage statistics
@@ -193,18 +1533,30 @@ ostream& operator<<(ostream& os, const MemoryManager& mm) {
     os << "Failed Allocations: " << mm.getFailedAllocations() << "\n";
 
     // List of all memory blocks in the pool
-    const Block* current = mm.getHeader();
-    int index = 0;
-    while (current != nullptr) {
-        os << "Block " << index++ << ": size=" << current->getSize()
-            << ", free=" << (current->isFree() ? "yes" : "no") << "\n";
-        current = current->getNext();
-    }
+    mm.printBlocks(os);
 
     return os;
 }
 
+// Print every block of the pool with its size and state
+// Regions are listed in address order when the pool has grown
+template <class Header>
+void BasicMemoryManager<Header>::printBlocks(ostream& os) const {
+    int index = 0;
+    for (size_t r = 0; r < m_regions.size(); r++) {
+        if (m_regions.size() > 1) {
+            os << "Region " << r << ": size=" << m_regions[r].end - m_regions[r].start << "\n";
+        }
+        const Header* current = (const Header*)m_regions[r].start;
+        while (current != nullptr) {
+            os << "Block " << index++ << ": size=" << current->getSize()
+                << ", free=" << (current->isFree() ? "yes" : "no") << "\n";
+            current = current->getNext();
+        }
+    }
+}
 
 
-
-
+// Header layouts available to the allocators
+template class BasicMemoryManager<Block>;
+template class BasicMemoryManager<CompactBlock>;
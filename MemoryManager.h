@@ -1,51 +1,492 @@
 #ifndef MEMORY_MANAGER_H
 #define MEMORY_MANAGER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "BackingStore.h"
 #include "Block.h"
+#include "TraceRecorder.h"
+#if MM_HARDENED
+#include <deque>
+#endif
 
+// Allocator instrumentation (split/merge counts, waste, scan histograms)
+// Build with -DMM_STATS=0 to compile the counting out; the snapshot then
+// only holds what can be read from the pool itself
+#ifndef MM_STATS
+#define MM_STATS 1
+#endif
+
+#if MM_STATS
+#define MM_STAT(statement) statement
+#else
+#define MM_STAT(statement)
+#endif
+
+
+// Snapshot of an allocator's statistics, returned by getStats()
+struct MemoryStats {
+    // Scan histograms count calls by the number of blocks they examined:
+    // 0, 1, 2-3, 4-7, 8-15, 16-31, 32-63 and 64 or more
+    static const int kScanBuckets = 8;
+
+    size_t usedMemory;            // Bytes in use, headers included
+    size_t freeMemory;            // Bytes not in use
+    size_t peakUsage;             // Highest usedMemory so far
+    size_t failedAllocations;     // Requests that returned nullptr
+
+    size_t freeBlocks;            // Number of free blocks
+    size_t largestFreeBlock;      // Largest request one free block can serve
+    double externalFragmentation; // 1 - largest free block / all free bytes
+
+    size_t splits;                // Blocks cut in two to fit a request
+    size_t merges;                // Neighbouring blocks joined into one
+    size_t internalWaste;         // Bytes handed out beyond the requests, over
+                                  // all allocations (remainders too small to
+                                  // split, power-of-two or class rounding)
+
+    size_t allocateScans[kScanBuckets];   // Allocations per blocks examined
+    size_t deallocateScans[kScanBuckets]; // Deallocations per blocks examined
+
+    MemoryStats();                       // All zero
+    static int scanBucket(size_t blocks); // Histogram bucket of a scan length
+};
+
+
+// Common interface and usage statistics of every allocator
 class MemoryManager {
 
     protected:
-        Block* m_memoryPool;      // Pointer to the first block
-        int m_peakUsage;          // Maximum memory used at any point
-        int m_totalSize;          // Total size of the memory pool
-        int m_usedSize;           // Current used memory
-        int m_failedAllocations;  // Count of failed allocation attempts
+        char* m_poolBuffer;       // Raw memory of the pool
+        size_t m_bufferSize;      // Bytes acquired for m_poolBuffer
+        BackingStore m_backing;   // Where pool memory comes from
+        size_t m_peakUsage;          // Maximum memory used at any point
+        size_t m_totalSize;          // Total size of the memory pool
+        size_t m_usedSize;           // Current used memory
+        size_t m_failedAllocations;  // Count of failed allocation attempts
+        size_t m_searchSteps;        // Blocks examined by allocation searches
+        MemoryStats m_stats;         // Counters updated through MM_STAT
+        TraceRecorder* m_recorder;   // Where calls are recorded (nullptr = off)
+
+        // Count one call that examined 'blocks' blocks in a scan histogram
+        void countScan(size_t* histogram, size_t blocks);
+
+        // Record a call that reaches the pool directly (returns 'ptr')
+        void* traceAllocate(size_t size, size_t alignment, void* ptr) {
+            if (m_recorder) m_recorder->recordAllocate(size, alignment, ptr);
+            return ptr;
+        }
+        void traceFree(const void* ptr) {
+            if (m_recorder) m_recorder->recordFree(ptr);
+        }
 
-        void mergeBlock(Block* block);  // Merge adjacent free blocks
+        // Pauses recording while a call built on other calls runs, so only
+        // the outer call is recorded (through the scope, once it has its
+        // result); the recorder is attached again when the scope ends
+        class TraceScope {
+            public:
+                explicit TraceScope(MemoryManager* owner)
+                    : m_owner(owner), m_recorder(owner->m_recorder) {
+                    owner->m_recorder = nullptr;
+                }
+                ~TraceScope() { m_owner->m_recorder = m_recorder; }
+
+                void* allocated(size_t size, size_t alignment, void* ptr) {
+                    if (m_recorder) m_recorder->recordAllocate(size, alignment, ptr);
+                    return ptr;
+                }
+                void* reallocated(const void* oldPtr, size_t size, void* ptr) {
+                    if (m_recorder) m_recorder->recordReallocate(oldPtr, size, ptr);
+                    return ptr;
+                }
+                size_t allocatedBatch(const size_t* sizes, size_t count, void* const* out,
+                    size_t allocated) {
+                    if (m_recorder) m_recorder->recordBatch(sizes, count, out);
+                    return allocated;
+                }
+
+            private:
+                MemoryManager* m_owner;
+                TraceRecorder* m_recorder;
+        };
+
+        static bool isValidAlignment(size_t alignment);  // Power of two check
+
+        // Print the block list (used by operator<<)
+        virtual void printBlocks(std::ostream& os) const = 0;
 
     public:
 
-        MemoryManager(int poolSize = 1024); // Constructor
+        // Constructor - the pool memory comes from 'backing' (heap by default)
+        MemoryManager(size_t poolSize = 1024,
+            const BackingStore& backing = BackingStore());
         virtual ~MemoryManager();           // Destructor
 
 
-        // Split block if it's larger than needed
-        bool splitBlock(Block* block, int size);  
+        // Allocate memory block (to be implemented by subclasses)
+        virtual void* allocate(size_t size) = 0;// Pure virtual allocation
 
+        // Allocate memory whose address is a multiple of 'alignment'
+        // (a power of two - 16/32/64 bytes, a page, ...)
+        virtual void* allocate(size_t size, size_t alignment) = 0;
+        virtual void deallocate(void* ptr) = 0; // Free memory at given pointer
 
-        // Allocate memory block (to be implemented by subclasses)
-        virtual void* allocate(int size) = 0;// Pure virtual allocation
-        void deallocate(void* ptr);     // Free memory at given pointer
+        // Resize a block, keeping its contents up to the smaller size
+        // Grows or shrinks in place when possible, otherwise moves the data
+        // Returns nullptr and keeps the block if no memory is available
+        virtual void* reallocate(void* ptr, size_t newSize) = 0;
+
+
+        /// --- Batches --- ///
+
+        // Allocate 'count' blocks of the given sizes into 'out'
+        // Entries that cannot be allocated are set to nullptr
+        // Returns the number of blocks allocated
+        virtual size_t allocateBatch(const size_t* sizes, size_t count, void** out);
+        size_t allocateBatch(size_t size, size_t count, void** out); // All the same size
+
+        // Free 'count' pointers at once (null entries are skipped)
+        virtual void deallocateBatch(void* const* ptrs, size_t count);
 
 
         /// --- Getters --- ///
 
-        int getTotalMemory() const;        // Total pool size
-        int getUsedMemory() const;         // Used memory
-        int getFreeMemory() const;         // Free memory
-        int getPeakUsage() const;          // Max used memory
-        int getFailedAllocations() const;  // Failed allocations count
-        const Block* getHeader() const;      // Return pointer to first block
+        size_t getTotalMemory() const;        // Total pool size
+        size_t getUsedMemory() const;         // Used memory
+        virtual size_t getResidentMemory() const; // Pool bytes backed by RAM
+        size_t getFreeMemory() const;         // Free memory
+        size_t getPeakUsage() const;          // Max used memory
+        size_t getFailedAllocations() const;  // Failed allocations count
+        size_t getSearchSteps() const;        // Blocks examined while searching
+        virtual double getFragmentation() const; // 1 - largest free / all free
+        virtual MemoryStats getStats() const; // Snapshot of every statistic
+        virtual size_t getHeaderSize() const; // Bytes of metadata per block
+        const BackingStore& getBackingStore() const; // Source of pool memory
+        TraceRecorder* getTraceRecorder() const; // Attached recorder (or nullptr)
         virtual const char* getAlgorithmName() const = 0;
 
 
-        void reset(int poolSize);                // Reset the memory pool
+        // Reset the memory pool (the buffer is reused when it is big enough)
+        virtual void reset(size_t poolSize);
+
+        // Free every live allocation at once, keeping the pool and its
+        // peak statistics (for request-scoped use)
+        virtual void releaseAll() = 0;
+
+
+        /// --- Tracing --- ///
+
+        // Record every allocate, deallocate and reallocate call (batches
+        // included) to 'recorder' from now on; nullptr stops recording
+        // The recorder is not owned and must outlive the recording
+        // reset(), releaseAll() and handle calls are not recorded
+        void setTraceRecorder(TraceRecorder* recorder);
 
 
         friend std::ostream& operator<<(std::ostream& os,
             const MemoryManager& mm); // Print state
 };
 
+
+// Free-block searches of the strategies (see FitPolicy.h)
+struct FirstFit;
+struct BestFit;
+struct WorstFit;
+struct NextFit;
+
+
+// Block-list manager shared by the fit strategies.
+// 'Header' is the block header layout (Block or CompactBlock), chosen at
+// compile time; the smaller the header, the less every allocation costs.
+template <class Header>
+class BasicMemoryManager : public MemoryManager {
+
+    // The searches walk the free-block index directly
+    friend struct FirstFit;
+    friend struct BestFit;
+    friend struct WorstFit;
+    friend struct NextFit;
+
+    protected:
+        typedef typename Header::WordType Word;
+
+        Header* m_memoryPool;     // Pointer to the first block
+        Header* m_rover;          // Where a next-fit search resumes (kept valid
+                                  // through merges, region release and reset)
+        Header* m_compactCursor;  // Where an incremental compaction resumes
+                                  // (kept valid like the rover)
+
+        // Contiguous memory holding its own chain of blocks
+        // The first region is the pool buffer, the others are added on growth
+        struct Region {
+            char* start;          // Header of the first block
+            char* end;            // End of the last block
+        };
+
+        std::vector<Region> m_regions; // Regions sorted by address
+        double m_growthFactor;    // Pool size multiplier per growth (0 = fixed)
+        size_t m_maxPoolSize;     // Growth cap in bytes (0 = no cap)
+        size_t m_trimThreshold;   // Free block size trimmed on deallocate (0 = off)
+
+        // Links of the free-block index, stored in the data area of free blocks
+        struct FreeLinks {
+            Header* prev;         // Previous free block in the same size class
+            Header* next;         // Next free block in the same size class
+        };
+
+        // Two-level size classes: each power of two (first level) is split
+        // into kSubClasses equal ranges (second level)
+        static const int kFirstLevels = 64;                // One per power of two
+        static const int kSubClassBits = 3;
+        static const int kSubClasses = 1 << kSubClassBits; // Ranges per power of two
+        static const int kNumSizeClasses = kFirstLevels * kSubClasses;
+        static const size_t kAlignment = 8;  // Granularity of block sizes and headers
+        // Smallest block data size: the free-list links and the size footer
+        static const size_t kMinPayload =
+            (sizeof(FreeLinks) + sizeof(Word) + kAlignment - 1) & ~(kAlignment - 1);
+
+#if MM_HARDENED
+        static const size_t kRedZoneSize = 16;          // Guard bytes after every payload (at least)
+        static const unsigned char kRedZoneByte = 0xFD; // Fill of the red zones
+        static const unsigned char kFreedByte = 0xDD;   // Fill of freed blocks
+        static const size_t kDefaultQuarantine = 32;    // Freed blocks held back
+
+        std::deque<Header*> m_quarantine; // Freed blocks not yet reusable, oldest first
+        size_t m_quarantineLimit;         // Blocks the quarantine holds at most
+#endif
+
+        Header* m_freeLists[kNumSizeClasses]; // Free blocks segregated by size class
+        Header* m_freeTails[kNumSizeClasses]; // Last block of each class (largest or highest)
+        bool m_addressOrdered;                // Classes sorted by address instead of size
+        uint64_t m_firstLevelMap;             // Bit per power of two with free blocks
+        unsigned int m_subClassMap[kFirstLevels]; // Bit per non-empty size class
+
+        // Handle table: the block of every live handle (nullptr = free slot)
+        // The slot number is stored in front of the handle's data, so the
+        // compactor can find the handle of a block it moves
+        std::vector<Header*> m_handles;
+        std::vector<size_t> m_freeHandles;   // Free slots, reused first
+        static const size_t kHandleSlotSize = kAlignment; // Slot number in front of the data
+
+        Header* mergeBlock(Header* block);  // Merge adjacent free blocks
+        void replaceBlock(Header* old, Header* block); // Move rover/cursor off a vanished header
+        void afterFree(Header* merged);     // Trim or release a new free run
+
+        // --- Free-block index --- //
+        static int sizeClass(size_t size);         // Class index of a block size
+        static Header* nextFree(Header* block);    // Next free block in its class
+        static Header* prevBlock(Header* block);   // Free block right before 'block'
+        int findNonEmptyClass(int cls) const;      // First non-empty class >= cls
+        int findLargestClass() const;              // Highest non-empty class
+        bool goesBefore(const Header* block, const Header* other) const; // Order inside a class
+        void insertFreeBlock(Header* block);       // Add a free block to the index, in class order
+        void removeFreeBlock(Header* block);       // Remove a block from the index
+        void clearFreeIndex();                     // Empty every size class
+        void initPool();                           // Single free block, empty index
+
+        // --- Regions --- //
+        bool growPool(size_t size);                // Add a region that fits 'size'
+        void releaseRegion(Header* block);         // Free a grown region left idle
+        void releaseGrownRegions();                // Free every grown region
+        void addRegion(char* start, size_t size);  // Format as one free block
+        int findRegion(const void* ptr) const;     // Region holding 'ptr' (-1 = none)
+
+        // Return the whole pages in a free block's data to the system
+        size_t purgeFreeBlock(Header* block);
+
+        // Mark a found block as used, split it and update usage statistics
+        void* placeAllocation(Header* block, size_t size);
+
+        // Allocate with the search of fit policy 'Fit' (growing the pool
+        // when nothing fits); defined here so the search can be inlined
+        template <class Fit>
+        void* allocateWith(size_t size);
+
+        // Round a request up to the block granularity (and minimum size)
+        static size_t roundRequest(size_t size);
+
+        // Block size a search must find for a request: the request itself,
+        // plus the red zone in hardened builds
+        static size_t guardSize(size_t size) {
+#if MM_HARDENED
+            return size <= (size_t)PTRDIFF_MAX / 2 ? size + kRedZoneSize : size;
+#else
+            return size;
+#endif
+        }
+
+#if MM_HARDENED
+        // --- Hardening --- //
+        void armBlock(Header* block, size_t size);    // Record the request, fill the red zone
+        void checkHeader(const Header* block) const;  // Header matches its checksum
+        void checkBlock(const Header* block) const;   // A used block the caller may still hold
+        bool isQuarantined(const Header* block) const;
+        void quarantine(Header* block);     // Poison a freed block and hold it back
+        void releaseQuarantined();          // Free the oldest held block for real
+#endif
+
+        // Move a movable block down into the free block in front of it
+        // Returns the free block that now follows it
+        Header* slideBlock(Header* hole, Header* block);
+
+        // Move the start of a used block forward by 'gap' bytes
+        Header* shiftBlockStart(Header* block, size_t gap);
+
+        // Find the header of the block owning the given data pointer
+        Header* blockFromPointer(void* ptr) const;
+        bool isValidHeader(const Header* block, const Region& region) const;
+
+        // Print the block list (used by operator<<)
+        void printBlocks(std::ostream& os) const;
+
+    public:
+
+        // Constructor - the fit policy decides whether size classes are kept
+        // in address order (first fit) or in size order (best/worst fit)
+        BasicMemoryManager(size_t poolSize = 1024,
+            const BackingStore& backing = BackingStore(), bool addressOrdered = false);
+        ~BasicMemoryManager();                      // Destructor
+
+
+        // Split block if it's larger than needed
+        bool splitBlock(Header* block, size_t size);
+
+
+        using MemoryManager::allocate;
+
+        // Allocate memory whose address is a multiple of 'alignment'
+        void* allocate(size_t size, size_t alignment);
+        void deallocate(void* ptr); // Free memory at given pointer
+
+        // Shrink by splitting, grow into a free following block, or move
+        void* reallocate(void* ptr, size_t newSize);
+
+        // Carve the whole batch out of one free block when possible
+        size_t allocateBatch(const size_t* sizes, size_t count, void** out);
+        using MemoryManager::allocateBatch;
+
+        // Free in address order, coalescing neighbouring blocks in one sweep
+        void deallocateBatch(void* const* ptrs, size_t count);
+
+        const Header* getHeader() const;   // Return pointer to first block
+        size_t getHeaderSize() const;      // sizeof(Header)
+        double getFragmentation() const;   // From the free blocks of all regions
+        MemoryStats getStats() const;      // Adds the free blocks of all regions
+
+        void reset(size_t poolSize);       // Reset the memory pool
+        void releaseAll();                 // Every region becomes one free block
+
+
+        /// --- Growth --- ///
+
+        // Let the pool grow by chaining new regions when no block fits
+        // Each growth multiplies the pool size by 'growthFactor' (> 1) and
+        // the pool never grows past 'maxPoolSize' bytes (0 = no cap)
+        void enableGrowth(double growthFactor = 2.0, size_t maxPoolSize = 0);
+        void disableGrowth();              // Keep the pool at its current size
+        size_t getRegionCount() const;     // Number of regions in the pool
+
+
+        /// --- Trimming --- ///
+
+        // Return the pages covered by free blocks to the system
+        // The pool keeps its addresses and size; only the resident memory
+        // drops. Returns the number of bytes released
+        size_t trim();
+
+        // Trim every free block of at least 'threshold' bytes as soon as a
+        // deallocation produces it (0 = only explicit trim() calls)
+        void setTrimThreshold(size_t threshold);
+        size_t getResidentMemory() const;  // Resident bytes of all regions
+
+
+        /// --- Handles and compaction --- ///
+
+        // Allocations made through handles are reached with resolve() and
+        // can be moved by compact(); plain pointers stay where they are
+        typedef size_t Handle;
+        static const Handle kNullHandle = 0;
+
+        // Allocate a movable block (kNullHandle if no memory is available)
+        // Throws invalid_argument if size is zero
+        virtual Handle allocateHandle(size_t size);
+
+        // Current address of a handle's data - valid until the next compact()
+        // Throws std::out_of_range if the handle is not live
+        void* resolve(Handle handle) const;
+
+        // Free the block of a handle (a null handle is ignored)
+        // Throws std::out_of_range if the handle is not live
+        void freeHandle(Handle handle);
+        size_t getHandleCount() const;     // Number of live handles
+
+        // Slide movable blocks down over the free space in front of them, so
+        // the free memory of each region gathers in one block at its end
+        // At most 'maxBytes' are moved per call (0 = no limit); the next call
+        // resumes where this one stopped
+        // Returns true once a pass over the whole pool has finished
+        bool compact(size_t maxBytes = 0);
+
+
+#if MM_HARDENED
+        /// --- Hardening (MM_HARDENED builds) --- ///
+
+        // Hold back up to 'maxBlocks' freed blocks (0 = free them at once)
+        void setQuarantineLimit(size_t maxBlocks);
+        size_t getQuarantinedBlocks() const;   // Blocks held back now
+
+        // Check the poison of every held block and free them for real
+        // (also done before an allocation fails or grows the pool)
+        // Throws logic_error if a held block was written to
+        void flushQuarantine();
+
+        // Walk the whole pool checking every header, the red zone of every
+        // used block and the poison of every held block
+        // Throws logic_error at the first damaged block
+        void checkHeap() const;
+#endif
+
+    protected:
+        Handle registerHandle(void* data); // Give a new block a handle
+        Header* handleBlock(Handle handle) const; // Block of a live handle
+};
+
+
+// Searches the pool with 'Fit', retries once in a region added by growth,
+// and hands the block out
+// Throws invalid_argument if size is zero
+template <class Header>
+template <class Fit>
+inline void* BasicMemoryManager<Header>::allocateWith(size_t size) {
+    if (size == 0) {
+        throw std::invalid_argument("Requested allocation size must be positive.");
+    }
+
+    MM_STAT(size_t stepsBefore = m_searchSteps);
+    size_t blockSize = guardSize(size);
+    Header* block = Fit::find(*this, blockSize);
+#if MM_HARDENED
+    if (!block && !m_quarantine.empty()) {
+        flushQuarantine(); // Held-back blocks before failing or growing
+        block = Fit::find(*this, blockSize);
+    }
+#endif
+    if (!block && growPool(blockSize)) {
+        block = Fit::find(*this, blockSize); // Retry in the region just added
+    }
+    MM_STAT(countScan(m_stats.allocateScans, m_searchSteps - stepsBefore));
+    if (!block) {
+        m_failedAllocations++;
+        return traceAllocate(size, 0, nullptr);
+    }
+
+    // Mark the block as used, split off the rest and update statistics
+    void* data = placeAllocation(block, size);
+    Fit::placed(*this, block);
+    return traceAllocate(size, 0, data);
+}
+
 #endif // MEMORY_MANAGER_H
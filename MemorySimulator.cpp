@@ -1,158 +1,124 @@
 #include "MemorySimulator.h"
 #include <iostream>
+#include <stdexcept>
 #include <vector>
-#include <cstdlib>
-#include <ctime>
 using namespace std;
 
 
-MemorySimulator::MemorySimulator(int iterations, int maxBlockSize) :
-    m_iterations(iterations),
+MemorySimulator::MemorySimulator(int iterations, int maxBlockSize, unsigned seed) :
+    m_iterations(iterations), m_seed(seed), m_random(seed),
     m_numAllocations(0), m_numFailedAllocations(0) {
 }
 
-
-void MemorySimulator::runAllScenarios(MemoryManager* allocator) {
-    srand(time(nullptr));
-    string scenarios[] = { "Random Allocations" ,
-                            "Increasing Size Allocations" ,
-                            "Decreasing Size Allocations" ,
-                            "Fragmentation Test",
-                            "Burst Allocations",
-                            "Mixed Overload" };
-
-    int numScenarios = 6;
-    for (int i = 0; i < numScenarios; i++) {
-        m_numAllocations = 0;
-        m_numFailedAllocations = 0;
-        allocator->reset(allocator->getTotalMemory());
-        runScenario(allocator, scenarios[i]);
-    }
+// Return the seed every run starts from
+unsigned MemorySimulator::getSeed() const {
+    return m_seed;
 }
 
-void MemorySimulator::runScenario(MemoryManager* allocator, const string& name) {
 
-    cout << "\n--- Scenario: " << name << " (" << allocator->getAlgorithmName() << ") ---\n";
-    if (name == "Random Allocations") {
-        randomAllocations(allocator);
-    }
-    else if (name == "Increasing Size Allocations") {
-        increasingSizeAllocations(allocator);
-    }
-    else if (name == "Decreasing Size Allocations") {
-        decreasingSizeAllocations(allocator);
-    }
-    else if (name == "Fragmentation Test") {
-        fragmentationTest(allocator);
-    }
-    else if (name == "Burst Allocations") {
-        burstAllocations(allocator);
-    }
-    else if (name == "Mixed Overload") {
-        mixedOverload(allocator);
-    }
-    printStatistics(allocator, name);
+// Return the scenario names (see Workload)
+const vector<string>& MemorySimulator::getScenarios() {
+    return Workload::getScenarios();
 }
 
-void MemorySimulator::randomAllocations(MemoryManager* allocator) {
-    vector<void*> blocks;
 
-    for (int i = 0; i < m_iterations; ++i) {
-        if (blocks.empty() || rand() % 2 == 0) {
-            m_numAllocations++;
-            int size = 16 + rand() % 128;
-            void* ptr = allocator->allocate(size);
-            if (ptr) blocks.push_back(ptr);
-            else m_numFailedAllocations++;
-        }
-        else {
-            int idx = rand() % blocks.size();
-            allocator->deallocate(blocks[idx]);
-            blocks.erase(blocks.begin() + idx);
-        }
+void MemorySimulator::runAllScenarios(MemoryManager* allocator) {
+    m_random.seed(m_seed);
+    const vector<string>& scenarios = getScenarios();
+    for (size_t i = 0; i < scenarios.size(); i++) {
+        runScenario(allocator, scenarios[i]);
     }
-    for (void* ptr : blocks) allocator->deallocate(ptr);
 }
 
-void MemorySimulator::increasingSizeAllocations(MemoryManager* allocator) {
-    vector<void*> blocks;
-    m_numAllocations = m_iterations;
-    for (int i = 4; i <= m_iterations * 4; i += 4) {
-        void* ptr = allocator->allocate(i);
-        if (ptr) blocks.push_back(ptr);
-        else m_numFailedAllocations++;
-
-    }
-    for (void* ptr : blocks) allocator->deallocate(ptr);
-}
+void MemorySimulator::runScenario(MemoryManager* allocator, const string& name) {
 
-void MemorySimulator::decreasingSizeAllocations(MemoryManager* allocator) {
-    vector<void*> blocks;
-    m_numAllocations = m_iterations;
-    for (int i = m_iterations * 4; i >= 4; i -= 4) {
-        void* ptr = allocator->allocate(i);
-        if (ptr) blocks.push_back(ptr);
-        else m_numFailedAllocations++;
-    }
-    for (void* ptr : blocks) allocator->deallocate(ptr);
+    cout << "\n--- Scenario: " << name << " (" << allocator->getAlgorithmName() << ") ---\n";
+    printStatistics(allocator, simulate(allocator, name));
 }
 
-void MemorySimulator::fragmentationTest(MemoryManager* allocator) {
-    vector<void*> blocks;
+// Resets the pool and the counters, runs the scenario and collects its
+// figures; the random generator continues from where it is
+// Throws invalid_argument if the scenario is unknown
+MemorySimulator::Outcome MemorySimulator::simulate(MemoryManager* allocator, const string& name) {
     m_numAllocations = 0;
-    for (int i = 0; i < m_iterations; ++i) {
-        m_numAllocations++;
-        void* ptr = allocator->allocate(64);
-        if (ptr) blocks.push_back(ptr);
-        else m_numFailedAllocations++;
-    }
-    for (size_t i = 0; i < blocks.size(); i += 2) {
-        allocator->deallocate(blocks[i]); // deallocate every other
-    }
-    //allocator->defragmantation(); // attempt to merge
-    for (size_t i = 1; i < blocks.size(); i += 2) {
-        m_numAllocations++;
-        if (!allocator->allocate(64))
-            m_numFailedAllocations++;
-    }
+    m_numFailedAllocations = 0;
+    allocator->reset(allocator->getTotalMemory());
+
+    run(allocator, Workload(name, m_iterations, m_random));
+
+    Outcome outcome;
+    outcome.allocations = m_numAllocations;
+    outcome.failedAllocations = m_numFailedAllocations;
+    outcome.peakUsage = allocator->getPeakUsage();
+    outcome.searchSteps = allocator->getSearchSteps();
+    outcome.stats = allocator->getStats();
+    return outcome;
 }
 
-void MemorySimulator::burstAllocations(MemoryManager* allocator) {
-    m_numAllocations = m_iterations;
-    int minSize = 32;
-    int maxSize = 64;
-    vector<void*> blocks;
-    for (int i = 0; i < m_numAllocations; ++i) {
-        int size = minSize + rand() % (maxSize - minSize + 1);
-        void* ptr = allocator->allocate(size);
-        if (ptr) blocks.push_back(ptr);
-        else m_numFailedAllocations++;
-    }
-    for (void* ptr : blocks) allocator->deallocate(ptr);
-}
+// Makes the calls of the workload, counting the blocks requested and the
+// failures; frees of blocks that could not be allocated are skipped
+void MemorySimulator::run(MemoryManager* allocator, const Workload& workload) {
+    const vector<Workload::Operation>& ops = workload.getOperations();
+    vector<void*> blocks(workload.getSlotCount(), nullptr);
+    vector<size_t> sizes;
+    vector<void*> batch;
+
+    for (size_t i = 0; i < ops.size(); ) {
+        size_t end = workload.getCallEnd(i);
+        if (ops[i].size && end - i > 1) {
+            sizes.clear();
+            for (size_t k = i; k < end; k++) {
+                sizes.push_back(ops[k].size);
+            }
+            batch.resize(sizes.size());
+            allocator->allocateBatch(sizes.data(), sizes.size(), batch.data());
+            for (size_t k = i; k < end; k++) {
+                blocks[ops[k].slot] = batch[k - i];
+            }
+        }
+        else if (end - i > 1) {
+            batch.clear();
+            for (size_t k = i; k < end; k++) {
+                batch.push_back(blocks[ops[k].slot]);
+                blocks[ops[k].slot] = nullptr;
+            }
+            allocator->deallocateBatch(batch.data(), batch.size());
+        }
+        else if (ops[i].size) {
+            blocks[ops[i].slot] = allocator->allocate(ops[i].size);
+        }
+        else if (blocks[ops[i].slot]) {
+            allocator->deallocate(blocks[ops[i].slot]);
+            blocks[ops[i].slot] = nullptr;
+        }
 
-void MemorySimulator::mixedOverload(MemoryManager* allocator) {
-    vector<void*> blocks;
-    int minSize = 32;
-    int maxSize = 64;
-    for (int i = 0; i < m_iterations; ++i) {
-        int size = (i % 2 == 0) ? minSize : maxSize;
-        void* ptr = allocator->allocate(size);
-        m_numAllocations++;
-        if (ptr) blocks.push_back(ptr);
-        else m_numFailedAllocations++;
-        if (i % 5 == 0 && !blocks.empty()) {
-            allocator->deallocate(blocks[0]);
-            blocks.erase(blocks.begin());
+        for (size_t k = i; k < end; k++) {
+            if (ops[k].size) {
+                m_numAllocations++;
+                if (!blocks[ops[k].slot]) m_numFailedAllocations++;
+            }
         }
+        i = end;
     }
-    for (void* ptr : blocks) allocator->deallocate(ptr);
 }
 
-void MemorySimulator::printStatistics(MemoryManager* allocator, const string& scenario) {
-
-    cout << "Failed Allocations: " << (double)m_numFailedAllocations / m_numAllocations * 100 << "%\n";
-    cout << "Peak Usage        : " << allocator->getPeakUsage() << " bytes\n";
+void MemorySimulator::printStatistics(MemoryManager* allocator, const Outcome& outcome) {
+
+    cout << "Failed Allocations: " << (double)outcome.failedAllocations / outcome.allocations * 100 << "%\n";
+    cout << "Peak Usage        : " << outcome.peakUsage << " bytes\n";
+    cout << "Header Size       : " << allocator->getHeaderSize() << " bytes per block\n";
+    cout << "Resident Memory   : " << allocator->getResidentMemory() << " bytes\n";
+    cout << "Search Steps      : " << outcome.searchSteps << " blocks\n";
+    const MemoryStats& stats = outcome.stats;
+    cout << "Fragmentation     : " << stats.externalFragmentation * 100 << "%\n";
+    cout << "Free Blocks       : " << stats.freeBlocks << " (largest " << stats.largestFreeBlock << " bytes)\n";
+    cout << "Splits / Merges   : " << stats.splits << " / " << stats.merges << "\n";
+    cout << "Internal Waste    : " << stats.internalWaste << " bytes\n";
+    cout << "Allocation Scans  :";
+    for (int i = 0; i < MemoryStats::kScanBuckets; i++) {
+        cout << " " << stats.allocateScans[i];
+    }
+    cout << " (0, 1, 2-3, ... 64+ blocks)\n";
 }
 
 
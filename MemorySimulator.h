@@ -2,30 +2,52 @@
 #define MEMORY_SIMULATOR_H
 
 #include "memoryManager.h"
+#include "Workload.h"
+#include <random>
 #include <string>
+#include <vector>
 
 class MemorySimulator {
 
     public:
 
-        MemorySimulator(int iterations = 100, int maxBlockSize = 128);
+        // Every allocator run gets the same random sequence from 'seed', so
+        // runs can be reproduced and allocators compared
+        static const unsigned kDefaultSeed = 12345;
+
+        // Figures of one scenario run
+        struct Outcome {
+            int allocations;          // Blocks requested
+            int failedAllocations;    // Requests that returned nullptr
+            size_t peakUsage;         // Peak usage of the pool
+            size_t searchSteps;       // Blocks examined by the searches
+            MemoryStats stats;        // Snapshot taken when the scenario ends
+        };
+
+        MemorySimulator(int iterations = 100, int maxBlockSize = 128,
+            unsigned seed = kDefaultSeed);
         //void run(MemoryManager* allocator, int iterations = 100, int maxBlockSize = 128);
         void runAllScenarios(MemoryManager* allocator);
 
-    private:
+        // Run one scenario on the reset pool without printing anything
+        // Throws invalid_argument if the scenario is unknown
+        Outcome simulate(MemoryManager* allocator, const std::string& scenario);
+
+        // Names of the scenarios (see Workload), in the order
+        // runAllScenarios() uses
+        static const std::vector<std::string>& getScenarios();
+        unsigned getSeed() const;
 
-        void randomAllocations(MemoryManager* allocator);
-        void increasingSizeAllocations(MemoryManager* allocator);
-        void decreasingSizeAllocations(MemoryManager* allocator);
-        void fragmentationTest(MemoryManager* allocator);
-        void burstAllocations(MemoryManager* allocator);
-        void mixedOverload(MemoryManager* allocator);
+    private:
 
+        void run(MemoryManager* allocator, const Workload& workload);
         void runScenario(MemoryManager* allocator, const std::string& name);
-        void printStatistics(MemoryManager* allocator, const std::string& scenario);
+        void printStatistics(MemoryManager* allocator, const Outcome& outcome);
         
 
         int m_iterations;
+        unsigned m_seed;          // Seed of every runAllScenarios call
+        std::mt19937 m_random;    // Random sizes and choices of the scenarios
         int m_numAllocations;
         int m_numFailedAllocations;
 };
@@ -0,0 +1,28 @@
+#include "NextFitAllocator.h"
+
+using namespace std;
+
+
+// Constructor - delegates to base class
+template <class Header>
+BasicNextFitAllocator<Header>::BasicNextFitAllocator(size_t poolSize, const BackingStore& backing)
+    : Base(poolSize, backing) {}
+
+// Return name of the algorithm
+template <class Header>
+const char* BasicNextFitAllocator<Header>::getAlgorithmName() const {
+    return NextFit::getName(sizeof(Header) == sizeof(CompactBlock));
+}
+
+
+// Allocate memory using Next-Fit Algorithm
+// Throws invalid_argument if requested size is zero
+template <class Header>
+void* BasicNextFitAllocator<Header>::allocate(size_t size) {
+    return this->template allocateWith<NextFit>(size);
+}
+
+
+// Header layouts available to the allocator
+template class BasicNextFitAllocator<Block>;
+template class BasicNextFitAllocator<CompactBlock>;
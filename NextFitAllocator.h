@@ -0,0 +1,36 @@
+#ifndef NEXT_FIT_ALLOCATOR_H
+#define NEXT_FIT_ALLOCATOR_H
+
+#include "FitPolicy.h"
+
+// Next fit: like first fit over the block list in address order, but each
+// search resumes where the previous allocation succeeded (the rover)
+// instead of at the start of the pool, wrapping around once.
+template <class Header>
+class BasicNextFitAllocator : public BasicMemoryManager<Header> {
+
+    protected:
+        typedef BasicMemoryManager<Header> Base;
+
+    public:
+        // Constructor - initialize memory pool with given size
+        BasicNextFitAllocator(size_t poolSize,
+            const BackingStore& backing = BackingStore());
+
+        // Allocate memory block using next-fit algorithm
+        // (the NextFit policy, through the virtual interface)
+        void* allocate(size_t size);
+        using Base::allocate;          // Aligned overload
+
+        // Return the name of the allocation algorithm
+        const char* getAlgorithmName() const;
+};
+
+// Allocator with the default 16-byte block header
+typedef BasicNextFitAllocator<Block> NextFitAllocator;
+
+// Allocator with the 8-byte block header (pools under 4 GiB)
+typedef BasicNextFitAllocator<CompactBlock> CompactNextFitAllocator;
+
+
+#endif // NEXT_FIT_ALLOCATOR_H
@@ -0,0 +1,132 @@
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include "FitPolicy.h"
+#include <mutex>
+
+// Lock policies of PoolAllocator
+
+// No locking - the allocator belongs to one thread; compiles to nothing
+struct NoLock {
+    void lock() {}
+    void unlock() {}
+};
+
+// One lock around every call, for an allocator shared between threads
+// Recursive, because the block manager's composite calls (aligned allocate,
+// reallocate, batches) call allocate again
+struct MutexLock {
+    void lock() { m_mutex.lock(); }
+    void unlock() { m_mutex.unlock(); }
+
+    private:
+        std::recursive_mutex m_mutex;
+};
+
+
+// Block-list allocator composed at compile time from a fit policy
+// (FirstFit, BestFit, WorstFit, NextFit), a header layout (Block or
+// CompactBlock) and a lock policy (NoLock or MutexLock).
+// The class is final, so calls made on a PoolAllocator (not through a
+// MemoryManager pointer) are direct and the fit search is inlined into the
+// caller's loop. It is still a MemoryManager, so it can be handed to code
+// written against the virtual interface.
+template <class Fit, class Header = Block, class Lock = NoLock>
+class PoolAllocator final : public BasicMemoryManager<Header> {
+
+    protected:
+        typedef BasicMemoryManager<Header> Base;
+        typedef std::lock_guard<Lock> Guard;
+
+        Lock m_lock;              // Taken by every call that changes the pool
+
+    public:
+        typedef typename Base::Handle Handle;
+
+        // Constructor - initialize memory pool with given size
+        PoolAllocator(size_t poolSize = 1024, const BackingStore& backing = BackingStore())
+            : Base(poolSize, backing, Fit::kAddressOrdered) {}
+
+        // Allocate with the fit policy's search
+        // Throws invalid_argument if size is zero
+        void* allocate(size_t size) {
+            Guard guard(m_lock);
+            return this->template allocateWith<Fit>(size);
+        }
+
+        void* allocate(size_t size, size_t alignment) {
+            Guard guard(m_lock);
+            return Base::allocate(size, alignment);
+        }
+
+        void deallocate(void* ptr) {
+            Guard guard(m_lock);
+            Base::deallocate(ptr);
+        }
+
+        void* reallocate(void* ptr, size_t newSize) {
+            Guard guard(m_lock);
+            return Base::reallocate(ptr, newSize);
+        }
+
+        size_t allocateBatch(const size_t* sizes, size_t count, void** out) {
+            Guard guard(m_lock);
+            return Base::allocateBatch(sizes, count, out);
+        }
+        using MemoryManager::allocateBatch;
+
+        void deallocateBatch(void* const* ptrs, size_t count) {
+            Guard guard(m_lock);
+            Base::deallocateBatch(ptrs, count);
+        }
+
+        void reset(size_t poolSize) {
+            Guard guard(m_lock);
+            Base::reset(poolSize);
+        }
+
+        void releaseAll() {
+            Guard guard(m_lock);
+            Base::releaseAll();
+        }
+
+        size_t trim() {
+            Guard guard(m_lock);
+            return Base::trim();
+        }
+
+        Handle allocateHandle(size_t size) {
+            Guard guard(m_lock);
+            return Base::allocateHandle(size);
+        }
+
+        void freeHandle(Handle handle) {
+            Guard guard(m_lock);
+            Base::freeHandle(handle);
+        }
+
+        bool compact(size_t maxBytes = 0) {
+            Guard guard(m_lock);
+            return Base::compact(maxBytes);
+        }
+
+#if MM_HARDENED
+        void setQuarantineLimit(size_t maxBlocks) {
+            Guard guard(m_lock);
+            Base::setQuarantineLimit(maxBlocks);
+        }
+
+        void flushQuarantine() {
+            Guard guard(m_lock);
+            Base::flushQuarantine();
+        }
+#endif
+
+        // Same names as the classic allocators: the strategy is the same
+        const char* getAlgorithmName() const {
+            return Fit::getName(sizeof(Header) == sizeof(CompactBlock));
+        }
+};
+
+
+#endif // POOL_ALLOCATOR_H
@@ -0,0 +1,185 @@
+#include "SimulationRunner.h"
+#include <atomic>
+#include <exception>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+
+// Constructor - an empty matrix
+// Throws invalid_argument if iterations is not positive
+SimulationRunner::SimulationRunner(int iterations, int maxBlockSize, unsigned threads)
+    : m_iterations(iterations), m_maxBlockSize(maxBlockSize), m_threads(threads) {
+    if (iterations <= 0) {
+        throw invalid_argument("Iterations must be positive.");
+    }
+    if (m_threads == 0) {
+        m_threads = thread::hardware_concurrency();
+    }
+    if (m_threads == 0) {
+        m_threads = 1; // The number of hardware threads is not known
+    }
+}
+
+
+// Add an allocator kind to the matrix
+void SimulationRunner::addAllocator(const Factory& factory) {
+    m_factories.push_back(factory);
+}
+
+// Add a scenario to the matrix
+void SimulationRunner::addScenario(const string& scenario) {
+    m_scenarios.push_back(scenario);
+}
+
+// Add a pool size to the matrix
+void SimulationRunner::addPoolSize(size_t poolSize) {
+    m_poolSizes.push_back(poolSize);
+}
+
+// Add a seed to the matrix
+void SimulationRunner::addSeed(unsigned seed) {
+    m_seeds.push_back(seed);
+}
+
+// Return the number of jobs run() makes
+size_t SimulationRunner::getJobCount() const {
+    return m_factories.size() *
+        (m_scenarios.empty() ? MemorySimulator::getScenarios().size() : m_scenarios.size()) *
+        (m_poolSizes.empty() ? 1 : m_poolSizes.size()) *
+        (m_seeds.empty() ? 1 : m_seeds.size());
+}
+
+// Return the number of worker threads
+unsigned SimulationRunner::getThreadCount() const {
+    return m_threads;
+}
+
+
+// Runs the matrix on the worker threads
+// The jobs are numbered in matrix order and handed out through a shared
+// counter; each result goes to the slot of its job, so no lock is needed
+// for them. After a job fails the workers stop taking new ones
+// Throws invalid_argument if no allocator was added or a scenario is unknown
+vector<SimulationRunner::Result> SimulationRunner::run() const {
+    if (m_factories.empty()) {
+        throw invalid_argument("No allocator to simulate.");
+    }
+
+    const vector<string>& known = MemorySimulator::getScenarios();
+    vector<string> scenarios = m_scenarios.empty() ? known : m_scenarios;
+    for (size_t i = 0; i < scenarios.size(); i++) {
+        bool found = false;
+        for (size_t j = 0; j < known.size() && !found; j++) {
+            found = scenarios[i] == known[j];
+        }
+        if (!found) {
+            throw invalid_argument("Unknown scenario: " + scenarios[i]);
+        }
+    }
+    vector<size_t> poolSizes = m_poolSizes.empty() ? vector<size_t>(1, 2048) : m_poolSizes;
+    unsigned defaultSeed = MemorySimulator::kDefaultSeed;
+    vector<unsigned> seeds = m_seeds.empty() ? vector<unsigned>(1, defaultSeed) : m_seeds;
+
+    size_t jobs = getJobCount();
+    vector<Result> results(jobs);
+    atomic<size_t> nextJob(0);
+    atomic<bool> failed(false);
+    exception_ptr error;
+    mutex errorLock;
+
+    // Job index = ((allocator * scenarios + scenario) * pools + pool) * seeds + seed
+    auto worker = [&]() {
+        for (size_t job; !failed && (job = nextJob++) < jobs; ) {
+            size_t index = job;
+            size_t seed = index % seeds.size();
+            index /= seeds.size();
+            size_t pool = index % poolSizes.size();
+            index /= poolSizes.size();
+            size_t scenario = index % scenarios.size();
+            size_t factory = index / scenarios.size();
+
+            try {
+                unique_ptr<MemoryManager> allocator(m_factories[factory](poolSizes[pool]));
+                MemorySimulator simulator(m_iterations, m_maxBlockSize, seeds[seed]);
+
+                Result& result = results[job];
+                result.outcome = simulator.simulate(allocator.get(), scenarios[scenario]);
+                result.algorithm = allocator->getAlgorithmName();
+                result.scenario = scenarios[scenario];
+                result.poolSize = poolSizes[pool];
+                result.seed = seeds[seed];
+            }
+            catch (...) {
+                lock_guard<mutex> guard(errorLock);
+                if (!error) {
+                    error = current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    size_t count = m_threads < jobs ? m_threads : jobs;
+    vector<thread> threads;
+    for (size_t i = 1; i < count; i++) {
+        threads.push_back(thread(worker));
+    }
+    worker(); // The calling thread works too
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+
+    if (error) {
+        rethrow_exception(error);
+    }
+    return results;
+}
+
+
+// Print one line per allocator, scenario and pool size
+// The seeds of one combination are next to each other in matrix order
+void SimulationRunner::printTable(ostream& os, const vector<Result>& results) {
+    os << left << setw(22) << "Algorithm" << setw(30) << "Scenario" << right
+        << setw(10) << "pool" << setw(7) << "seeds" << setw(10) << "failed %"
+        << setw(10) << "peak min" << setw(10) << "peak max" << setw(8) << "frag %"
+        << setw(10) << "steps" << "\n";
+
+    os << fixed << setprecision(1);
+    for (size_t first = 0; first < results.size(); ) {
+        const Result& r = results[first];
+        size_t last = first;
+        while (last < results.size() && results[last].algorithm == r.algorithm &&
+            results[last].scenario == r.scenario && results[last].poolSize == r.poolSize) {
+            last++;
+        }
+
+        double failed = 0;
+        double fragmentation = 0;
+        double steps = 0;
+        size_t peakMin = r.outcome.peakUsage;
+        size_t peakMax = r.outcome.peakUsage;
+        for (size_t i = first; i < last; i++) {
+            const MemorySimulator::Outcome& o = results[i].outcome;
+            failed += o.allocations ? (double)o.failedAllocations / o.allocations * 100 : 0;
+            fragmentation += o.stats.externalFragmentation * 100;
+            steps += (double)o.searchSteps;
+            peakMin = o.peakUsage < peakMin ? o.peakUsage : peakMin;
+            peakMax = o.peakUsage > peakMax ? o.peakUsage : peakMax;
+        }
+        double seeds = (double)(last - first);
+
+        os << left << setw(22) << r.algorithm << setw(30) << r.scenario << right
+            << setw(10) << r.poolSize << setw(7) << (last - first)
+            << setw(10) << failed / seeds << setw(10) << peakMin << setw(10) << peakMax
+            << setw(8) << fragmentation / seeds << setprecision(0) << setw(10) << steps / seeds
+            << setprecision(1) << "\n";
+        first = last;
+    }
+    os.unsetf(ios::floatfield);
+    os << setprecision(6);
+}
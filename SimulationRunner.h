@@ -0,0 +1,67 @@
+#ifndef SIMULATION_RUNNER_H
+#define SIMULATION_RUNNER_H
+
+#include "MemorySimulator.h"
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Runs the simulator over a parameter matrix in parallel.
+// Every combination of allocator, scenario, pool size and seed is one job;
+// a fixed number of worker threads take the jobs in turn. Each job builds
+// its own allocator and its own MemorySimulator (and so its own random
+// generator), so jobs share nothing and the results do not depend on the
+// number of threads or the order the jobs finish in.
+class SimulationRunner {
+
+    public:
+        // Builds a new allocator with the given pool size; the runner
+        // deletes it when the job is done
+        typedef std::function<MemoryManager*(size_t poolSize)> Factory;
+
+        // Outcome of one job
+        struct Result {
+            std::string algorithm;
+            std::string scenario;
+            size_t poolSize;
+            unsigned seed;
+            MemorySimulator::Outcome outcome;
+        };
+
+        // Constructor - 'threads' workers (0 = one per hardware thread)
+        // Throws invalid_argument if iterations is not positive
+        SimulationRunner(int iterations = 100, int maxBlockSize = 128,
+            unsigned threads = 0);
+
+        // --- The matrix --- //
+        void addAllocator(const Factory& factory);
+        void addScenario(const std::string& scenario); // Every scenario if none is added
+        void addPoolSize(size_t poolSize);            // 2048 bytes if none is added
+        void addSeed(unsigned seed);                  // kDefaultSeed if none is added
+        size_t getJobCount() const;
+        unsigned getThreadCount() const;
+
+        // Run every job and return the results in matrix order (allocator,
+        // then scenario, pool size and seed)
+        // Throws invalid_argument if no allocator was added or a scenario is
+        // unknown; an exception thrown by a job is rethrown once every
+        // worker has stopped
+        std::vector<Result> run() const;
+
+        // One line per allocator, scenario and pool size, over all seeds
+        // (failure rate and fragmentation are averaged, peaks are the range)
+        static void printTable(std::ostream& os, const std::vector<Result>& results);
+
+    private:
+        int m_iterations;
+        int m_maxBlockSize;
+        unsigned m_threads;
+        std::vector<Factory> m_factories;
+        std::vector<std::string> m_scenarios;
+        std::vector<size_t> m_poolSizes;
+        std::vector<unsigned> m_seeds;
+};
+
+
+#endif // SIMULATION_RUNNER_H
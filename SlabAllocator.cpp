@@ -0,0 +1,247 @@
+#include "SlabAllocator.h"
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+
+// Constructor - delegates the pool to the base class and sets up the slabs
+// Throws invalid_argument if the slab size cannot hold the smallest object
+SlabAllocator::SlabAllocator(size_t poolSize, size_t slabSize,
+    const BackingStore& backing)
+    : MemoryManager(poolSize, backing), m_slabSize(slabSize) {
+    if (slabSize < kMinObjectSize) {
+        throw invalid_argument("Slab size too small to hold an object.");
+    }
+    initSlabs();
+}
+
+// Return name of the algorithm
+const char* SlabAllocator::getAlgorithmName() const {
+    return "Slab";
+}
+
+
+// Allocate an object from the free stack of its size class
+// Throws invalid_argument if requested size is zero
+void* SlabAllocator::allocate(size_t size) {
+    if (size == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+
+    // Requests larger than a slab can never be served
+    int cls = classIndex(size);
+    if (cls < 0 || (!m_freeStacks[cls] && !carveSlab(cls))) {
+        m_failedAllocations++;
+        return traceAllocate(size, 0, nullptr);
+    }
+
+    // Pop the top of the free stack
+    FreeObject* object = m_freeStacks[cls];
+    m_freeStacks[cls] = object->next;
+    m_freeObjects[((char*)object - m_poolBuffer) / kMinObjectSize] = false;
+    m_slabLive[((char*)object - m_poolBuffer) / m_slabSize]++;
+
+    // The whole object is charged, including rounding to the class size
+    m_usedSize += kMinObjectSize << cls;
+    MM_STAT(m_stats.internalWaste += (kMinObjectSize << cls) - size);
+    if (m_usedSize > m_peakUsage) {
+        m_peakUsage = m_usedSize;
+    }
+    return traceAllocate(size, 0, object);
+}
+
+
+
+// Objects are aligned to their power-of-two size inside the pool, so an
+// aligned request is served from the class of max(size, alignment)
+// Pools start on a page boundary, so alignments up to a page are met
+// whenever the slab size is a multiple of the alignment; larger ones may fail
+// Throws invalid_argument if size is zero or alignment is invalid
+void* SlabAllocator::allocate(size_t size, size_t alignment) {
+    if (size == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+    if (!isValidAlignment(alignment)) {
+        throw invalid_argument("Alignment must be a power of two.");
+    }
+
+    TraceScope trace(this);
+    void* ptr = allocate(size < alignment ? alignment : size);
+    if (ptr && ((size_t)ptr & (alignment - 1)) != 0) {
+        deallocate(ptr);
+        m_failedAllocations++;
+        return trace.allocated(size, alignment, nullptr);
+    }
+    return trace.allocated(size, alignment, ptr);
+}
+
+
+// Push an object back onto the free stack of its size class
+// Does nothing if the pointer is null or the object is already free
+// Throws std::out_of_range if the pointer is not an object of this pool
+void SlabAllocator::deallocate(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    int cls = objectClass(ptr);
+    size_t index = ((char*)ptr - m_poolBuffer) / kMinObjectSize;
+    if (m_freeObjects[index]) {
+        return; // Already free - pushing it again would cycle the stack
+    }
+    m_freeObjects[index] = true;
+    size_t slab = ((char*)ptr - m_poolBuffer) / m_slabSize;
+    size_t objectSize = kMinObjectSize << cls;
+    traceFree(ptr);
+
+    FreeObject* object = (FreeObject*)ptr;
+    object->next = m_freeStacks[cls];
+    m_freeStacks[cls] = object;
+    m_slabLive[slab]--;
+    m_usedSize -= objectSize;
+}
+
+
+// Reset the memory pool and all slab assignments
+void SlabAllocator::reset(size_t poolSize) {
+    MemoryManager::reset(poolSize);
+    initSlabs();
+}
+
+
+// Free every object by forgetting the slabs handed out so far
+// Only the free stacks are cleared; slab data is rebuilt when carved again
+void SlabAllocator::releaseAll() {
+    m_nextSlab = 0;
+    m_freeStacks.assign(m_freeStacks.size(), nullptr);
+    m_usedSize = 0;
+}
+
+
+// Return the number of bytes per slab
+size_t SlabAllocator::getSlabSize() const {
+    return m_slabSize;
+}
+
+// Return the number of slabs in the pool
+size_t SlabAllocator::getSlabCount() const {
+    return m_numSlabs;
+}
+
+
+// Return the smallest power-of-two class holding 'size' bytes
+// Returns -1 if the size does not fit in a slab
+int SlabAllocator::classIndex(size_t size) const {
+    int cls = 0;
+    size_t objectSize = kMinObjectSize;
+    while (objectSize < size && objectSize <= m_slabSize) {
+        objectSize <<= 1;
+        cls++;
+    }
+    return objectSize <= m_slabSize ? cls : -1;
+}
+
+
+// Take the next unused slab, assign it to a class and push all its objects
+// Returns false if every slab is already in use
+bool SlabAllocator::carveSlab(int cls) {
+    if (m_nextSlab >= m_numSlabs) {
+        return false;
+    }
+
+    size_t slab = m_nextSlab++;
+    size_t objectSize = kMinObjectSize << cls;
+    char* slabStart = m_poolBuffer + slab * m_slabSize;
+    m_slabClass[slab] = cls;
+    m_slabLive[slab] = 0;
+
+    // Push in reverse so objects are handed out in address order
+    for (size_t offset = m_slabSize / objectSize * objectSize; offset > 0; ) {
+        offset -= objectSize;
+        FreeObject* object = (FreeObject*)(slabStart + offset);
+        object->next = m_freeStacks[cls];
+        m_freeStacks[cls] = object;
+        m_freeObjects[(slab * m_slabSize + offset) / kMinObjectSize] = true;
+    }
+    return true;
+}
+
+
+// Resize an object
+// Objects cannot grow, so the object stays while the new size fits its
+// class and moves to a larger class otherwise
+// Throws invalid_argument if the new size is zero
+// Throws std::out_of_range if the pointer is not an object of this pool
+void* SlabAllocator::reallocate(void* ptr, size_t newSize) {
+    if (!ptr) {
+        return allocate(newSize);
+    }
+    if (newSize == 0) {
+        throw invalid_argument("Requested allocation size must be positive.");
+    }
+
+    size_t objectSize = kMinObjectSize << objectClass(ptr);
+    TraceScope trace(this);
+    if (newSize <= objectSize) {
+        return trace.reallocated(ptr, newSize, ptr);
+    }
+
+    void* moved = allocate(newSize);
+    if (!moved) {
+        return trace.reallocated(ptr, newSize, nullptr);
+    }
+    memcpy(moved, ptr, objectSize);
+    deallocate(ptr);
+    return trace.reallocated(ptr, newSize, moved);
+}
+
+// Return the size class of the object starting at 'ptr'
+// Throws std::out_of_range if the pointer is outside the slabs in use or
+// not the start of an object
+int SlabAllocator::objectClass(void* ptr) const {
+    // Range check - the pointer must lie inside a slab in use
+    char* poolStart = m_poolBuffer;
+    char* data = (char*)ptr;
+    if (data < poolStart || data >= poolStart + m_nextSlab * m_slabSize) {
+        throw out_of_range("Cannot deallocate: pointer does not belong to memory pool.");
+    }
+
+    size_t slab = (data - poolStart) / m_slabSize;
+    int cls = m_slabClass[slab];
+    size_t objectSize = kMinObjectSize << cls;
+    size_t offset = (data - poolStart) % m_slabSize;
+
+    // The pointer must be the start of an object of the slab's class
+    if (offset % objectSize != 0 || offset + objectSize > m_slabSize) {
+        throw out_of_range("Cannot deallocate: pointer is not the start of an object.");
+    }
+    return cls;
+}
+
+
+// Mark every slab as unused and empty all free stacks
+void SlabAllocator::initSlabs() {
+    // One class per power of two that fits in a slab
+    int numClasses = 0;
+    while ((kMinObjectSize << numClasses) <= m_slabSize) {
+        numClasses++;
+    }
+
+    m_numSlabs = m_totalSize / m_slabSize;
+    m_nextSlab = 0;
+    m_slabClass.assign(m_numSlabs, -1);
+    m_slabLive.assign(m_numSlabs, 0);
+    m_freeStacks.assign(numClasses, nullptr);
+    m_freeObjects.assign(m_numSlabs * m_slabSize / kMinObjectSize, false);
+}
+
+
+// Print every slab handed out so far
+void SlabAllocator::printBlocks(ostream& os) const {
+    for (size_t slab = 0; slab < m_nextSlab; slab++) {
+        os << "Slab " << slab << ": object size=" << (kMinObjectSize << m_slabClass[slab])
+            << ", live=" << m_slabLive[slab] << "\n";
+    }
+    os << "Unused slabs: " << m_numSlabs - m_nextSlab << "\n";
+}
@@ -0,0 +1,70 @@
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include "MemoryManager.h"
+#include <vector>
+
+// Fixed-size object allocator.
+// The pool is carved into equal slabs; each slab serves one power-of-two
+// object size. Free objects of a size form an intrusive stack, so allocate
+// and deallocate are O(1) and objects carry no Block header.
+class SlabAllocator : public MemoryManager {
+
+    public:
+        static const size_t kMinObjectSize = 8; // Smallest object (holds a link)
+
+        // Constructor - initialize memory pool split into slabs of 'slabSize'
+        SlabAllocator(size_t poolSize, size_t slabSize = 256,
+            const BackingStore& backing = BackingStore());
+
+        // Allocate an object of the smallest size class that fits
+        void* allocate(size_t size);
+
+        // Allocate an object whose address is a multiple of 'alignment'
+        void* allocate(size_t size, size_t alignment);
+
+        // Return an object to the free stack of its size class
+        // (freeing an object twice is ignored)
+        void deallocate(void* ptr);
+
+        // Keep the object while the new size fits its class, else move it
+        void* reallocate(void* ptr, size_t newSize);
+
+        // Reset the pool and forget every slab assignment
+        void reset(size_t poolSize);
+
+        // Free every object at once - all slabs become unused again
+        void releaseAll();
+
+        // Return the name of the allocation algorithm
+        const char* getAlgorithmName() const;
+
+        size_t getSlabSize() const;   // Bytes per slab
+        size_t getSlabCount() const;  // Number of slabs in the pool
+
+    protected:
+        // Print the slabs with their object size and live object count
+        void printBlocks(std::ostream& os) const;
+
+    private:
+        // Link stored in every free object
+        struct FreeObject {
+            FreeObject* next;
+        };
+
+        int classIndex(size_t size) const; // Size class for a request size
+        int objectClass(void* ptr) const;  // Size class of a live object
+        bool carveSlab(int cls);          // Assign a fresh slab to a class
+        void initSlabs();                 // Clear all slab metadata
+
+        size_t m_slabSize;                // Bytes per slab
+        size_t m_numSlabs;                // Slabs that fit in the pool
+        size_t m_nextSlab;                // First slab never handed out
+        std::vector<int> m_slabClass;     // Class of each slab (-1 = unused)
+        std::vector<int> m_slabLive;      // Live objects in each slab
+        std::vector<FreeObject*> m_freeStacks; // Free objects per class
+        std::vector<bool> m_freeObjects;  // Object is on a free stack (per 8 bytes)
+};
+
+
+#endif // SLAB_ALLOCATOR_H
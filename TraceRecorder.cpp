@@ -0,0 +1,139 @@
+#include "TraceRecorder.h"
+#include <stdexcept>
+
+using namespace std;
+
+
+const char kTraceMagic[8] = { 'M', 'M', 'T', 'R', 'A', 'C', 'E', '\0' };
+
+
+// ---- Trace events ---- //
+
+// Return what kind of call the event records
+TraceEvent::Kind TraceEvent::getKind() const {
+    return (Kind)(sizeAndKind & 3);
+}
+
+// Return the requested size
+size_t TraceEvent::getSize() const {
+    return (size_t)(sizeAndKind >> 8);
+}
+
+// Return the requested alignment (0 for a plain allocation)
+size_t TraceEvent::getAlignment() const {
+    unsigned shift = (unsigned)(sizeAndKind >> 2) & 63;
+    return shift ? (size_t)1 << shift : 0;
+}
+
+
+// ---- Recorder ---- //
+
+// Constructor - opens the file and writes the header
+// Throws invalid_argument if the file cannot be opened
+TraceRecorder::TraceRecorder(const string& path)
+    : m_file(path.c_str(), ios::binary | ios::trunc), m_nextId(0), m_eventCount(0),
+    m_start(chrono::steady_clock::now()) {
+    if (!m_file) {
+        throw invalid_argument("Cannot open trace file for writing: " + path);
+    }
+
+    TraceFileHeader header;
+    for (int i = 0; i < 8; i++) {
+        header.magic[i] = kTraceMagic[i];
+    }
+    header.version = kTraceVersion;
+    header.eventSize = sizeof(TraceEvent);
+    m_file.write((const char*)&header, sizeof(header));
+    m_buffer.reserve(kBufferEvents);
+}
+
+// Destructor - writes what is still buffered
+TraceRecorder::~TraceRecorder() {
+    flush();
+}
+
+
+// Record an allocation; a failed one gets an id as well, so the replay
+// makes the same request
+void TraceRecorder::recordAllocate(size_t size, size_t alignment, const void* ptr) {
+    uint64_t id = m_nextId++;
+    if (ptr) {
+        m_ids[ptr] = id;
+    }
+    append(TraceEvent::kAllocate, id, size, alignment);
+}
+
+// Record a free
+// Blocks allocated before the recording started are not in the trace, so
+// their frees are left out as well
+void TraceRecorder::recordFree(const void* ptr) {
+    unordered_map<const void*, uint64_t>::iterator found = m_ids.find(ptr);
+    if (found == m_ids.end()) {
+        return;
+    }
+    append(TraceEvent::kFree, found->second, 0, 0);
+    m_ids.erase(found);
+}
+
+// Record a resize; the block keeps its id when it moves
+// A null or unknown old pointer is recorded as an allocation
+void TraceRecorder::recordReallocate(const void* oldPtr, size_t size, const void* newPtr) {
+    unordered_map<const void*, uint64_t>::iterator found = m_ids.find(oldPtr);
+    if (!oldPtr || found == m_ids.end()) {
+        recordAllocate(size, 0, newPtr);
+        return;
+    }
+
+    uint64_t id = found->second;
+    if (newPtr) {
+        m_ids.erase(found);
+        m_ids[newPtr] = id;
+    }
+    append(TraceEvent::kReallocate, id, size, 0);
+}
+
+// Record a batch: a kBatch event with the block count, then one allocate
+// event per block
+void TraceRecorder::recordBatch(const size_t* sizes, size_t count, void* const* out) {
+    append(TraceEvent::kBatch, 0, count, 0);
+    for (size_t i = 0; i < count; i++) {
+        recordAllocate(sizes[i], 0, out[i]);
+    }
+}
+
+
+// Write the buffered events to the file
+void TraceRecorder::flush() {
+    if (!m_buffer.empty()) {
+        m_file.write((const char*)m_buffer.data(), m_buffer.size() * sizeof(TraceEvent));
+        m_buffer.clear();
+    }
+    m_file.flush();
+}
+
+// Return the number of events recorded
+uint64_t TraceRecorder::getEventCount() const {
+    return m_eventCount;
+}
+
+
+// Add an event to the buffer, writing the buffer out once it is full
+void TraceRecorder::append(TraceEvent::Kind kind, uint64_t id, size_t size, size_t alignment) {
+    unsigned shift = 0;
+    while (alignment > 1 && ((size_t)1 << shift) < alignment) {
+        shift++;
+    }
+
+    TraceEvent event;
+    event.timestamp = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now() - m_start).count();
+    event.id = id;
+    event.sizeAndKind = (uint64_t)size << 8 | (uint64_t)shift << 2 | (uint64_t)kind;
+    m_buffer.push_back(event);
+    m_eventCount++;
+
+    if (m_buffer.size() == kBufferEvents) {
+        m_file.write((const char*)m_buffer.data(), m_buffer.size() * sizeof(TraceEvent));
+        m_buffer.clear();
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One allocator call of a trace file (24 bytes, native byte order).
+// The size, the alignment and the kind of call share one word:
+// size << 8 | log2(alignment) << 2 | kind
+struct TraceEvent {
+    enum Kind {
+        kAllocate = 0,    // allocate(size) or allocate(size, alignment)
+        kFree = 1,        // deallocate(ptr)
+        kReallocate = 2,  // reallocate(ptr, size)
+        kBatch = 3        // allocateBatch of the next 'size' allocate events
+    };
+
+    uint64_t timestamp;   // Nanoseconds since the recording started
+    uint64_t id;          // Allocation the event belongs to
+    uint64_t sizeAndKind; // Request size, alignment and kind
+
+    Kind getKind() const;
+    size_t getSize() const;
+    size_t getAlignment() const;   // 0 for plain allocations
+};
+
+// Header at the start of a trace file
+struct TraceFileHeader {
+    char magic[8];        // kTraceMagic
+    uint32_t version;     // kTraceVersion
+    uint32_t eventSize;   // sizeof(TraceEvent)
+};
+
+extern const char kTraceMagic[8];
+const uint32_t kTraceVersion = 1;
+
+
+// Writes the calls made on a MemoryManager to a binary trace file.
+// Attach it with MemoryManager::setTraceRecorder. Every allocation gets an
+// id; later frees and resizes of the same block refer to that id, so the
+// trace can be replayed on any allocator (see TraceReplayer). Events are
+// buffered and written in blocks.
+// A recorder is not thread-safe: attach it to allocators used by one thread
+// (or behind ConcurrentAllocator, which locks the pool).
+class TraceRecorder {
+
+    public:
+        // Constructor - creates (or truncates) the trace file
+        // Throws invalid_argument if the file cannot be opened
+        explicit TraceRecorder(const std::string& path);
+        ~TraceRecorder();                    // Writes the buffered events
+
+        // Record a call and its result (nullptr = the call failed)
+        void recordAllocate(size_t size, size_t alignment, const void* ptr);
+        void recordFree(const void* ptr);
+        void recordReallocate(const void* oldPtr, size_t size, const void* newPtr);
+        void recordBatch(const size_t* sizes, size_t count, void* const* out);
+
+        void flush();                        // Write the buffered events
+        uint64_t getEventCount() const;      // Events recorded so far
+
+    private:
+        void append(TraceEvent::Kind kind, uint64_t id, size_t size, size_t alignment);
+
+        static const size_t kBufferEvents = 4096; // Events written per block
+
+        std::ofstream m_file;
+        std::vector<TraceEvent> m_buffer;    // Events not written yet
+        std::unordered_map<const void*, uint64_t> m_ids; // Live block -> id
+        uint64_t m_nextId;
+        uint64_t m_eventCount;
+        std::chrono::steady_clock::time_point m_start;
+};
+
+
+#endif // TRACE_RECORDER_H
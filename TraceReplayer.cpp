@@ -0,0 +1,233 @@
+#include "TraceReplayer.h"
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+
+// Constructor - maps the trace (or opens it for block reads where mmap is
+// not available) and checks the header
+// Throws invalid_argument if the file cannot be read, has a foreign header
+// or ends in the middle of an event
+TraceReplayer::TraceReplayer(const string& path)
+    : m_eventCount(0), m_map(nullptr), m_mapSize(0), m_released(0) {
+    TraceFileHeader header;
+    size_t fileSize = 0;
+
+#if defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(header)) {
+        void* map = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            m_map = (char*)map;
+            m_mapSize = (size_t)info.st_size;
+            madvise(m_map, m_mapSize, MADV_SEQUENTIAL); // Read ahead, drop behind
+        }
+    }
+    if (fd >= 0) {
+        close(fd); // The mapping stays valid
+    }
+#endif
+
+    if (m_map) {
+        memcpy(&header, m_map, sizeof(header));
+        fileSize = m_mapSize;
+    }
+    else {
+        m_file.open(path.c_str(), ios::binary);
+        if (!m_file) {
+            throw invalid_argument("Cannot open trace file: " + path);
+        }
+        m_file.seekg(0, ios::end);
+        fileSize = (size_t)m_file.tellg();
+        m_file.seekg(0, ios::beg);
+        if (fileSize < sizeof(header) || !m_file.read((char*)&header, sizeof(header))) {
+            throw invalid_argument("Not a trace file: " + path);
+        }
+    }
+
+    if (memcmp(header.magic, kTraceMagic, sizeof(header.magic)) != 0 ||
+        header.version != kTraceVersion || header.eventSize != sizeof(TraceEvent)) {
+        unmap();
+        throw invalid_argument("Not a trace file of this version: " + path);
+    }
+    if ((fileSize - sizeof(header)) % sizeof(TraceEvent) != 0) {
+        unmap();
+        throw invalid_argument("Trace file ends in the middle of an event: " + path);
+    }
+    m_eventCount = (fileSize - sizeof(header)) / sizeof(TraceEvent);
+}
+
+// Destructor - unmaps the file
+TraceReplayer::~TraceReplayer() {
+    unmap();
+}
+
+
+// Replays the trace: every id is mapped to the block its allocation got on
+// this allocator, so frees and resizes reach the right block
+// Requests that failed in the recording are made again; events of an id
+// whose allocation failed here are skipped (a resize becomes an allocation)
+// The allocate events of a batch are collected and made as one batch
+TraceReplayer::Result TraceReplayer::replay(MemoryManager* allocator) {
+    Result result;
+    memset(&result, 0, sizeof(result));
+
+    unordered_map<uint64_t, void*> live;
+    size_t batchLeft = 0;                  // Allocate events still to collect
+    vector<size_t> batchSizes;
+    vector<uint64_t> batchIds;
+    vector<void*> batchOut;
+    size_t peak = allocator->getUsedMemory();  // Highest usage between two events
+    size_t peakBefore = allocator->getPeakUsage();
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    uint64_t index = 0;
+    const TraceEvent* events = nullptr;
+    for (size_t count; (count = fetch(index, events)) > 0; index += count) {
+        for (size_t i = 0; i < count; i++) {
+            const TraceEvent& event = events[i];
+            unordered_map<uint64_t, void*>::iterator found = live.find(event.id);
+
+            switch (event.getKind()) {
+                case TraceEvent::kBatch:
+                    batchLeft = event.getSize();
+                    batchSizes.clear();
+                    batchIds.clear();
+                    break;
+                case TraceEvent::kAllocate: {
+                    if (batchLeft > 0) {
+                        batchSizes.push_back(event.getSize());
+                        batchIds.push_back(event.id);
+                        if (--batchLeft > 0) {
+                            break;
+                        }
+                        batchOut.resize(batchSizes.size());
+                        allocator->allocateBatch(batchSizes.data(), batchSizes.size(), batchOut.data());
+                        for (size_t j = 0; j < batchOut.size(); j++) {
+                            if (batchOut[j]) {
+                                live[batchIds[j]] = batchOut[j];
+                            }
+                            else {
+                                result.failedAllocations++;
+                            }
+                        }
+                        result.allocations += batchOut.size();
+                        break;
+                    }
+                    size_t alignment = event.getAlignment();
+                    void* ptr = alignment ? allocator->allocate(event.getSize(), alignment)
+                                          : allocator->allocate(event.getSize());
+                    result.allocations++;
+                    if (ptr) {
+                        live[event.id] = ptr;
+                    }
+                    else {
+                        result.failedAllocations++;
+                    }
+                    break;
+                }
+                case TraceEvent::kFree:
+                    if (found != live.end()) {
+                        allocator->deallocate(found->second);
+                        live.erase(found);
+                        result.frees++;
+                    }
+                    break;
+                case TraceEvent::kReallocate: {
+                    void* old = found != live.end() ? found->second : nullptr;
+                    void* ptr = allocator->reallocate(old, event.getSize());
+                    result.reallocations++;
+                    if (ptr) {
+                        live[event.id] = ptr;
+                    }
+                    else {
+                        result.failedAllocations++; // The old block stays valid
+                    }
+                    break;
+                }
+            }
+
+            if (allocator->getUsedMemory() > peak) {
+                peak = allocator->getUsedMemory();
+            }
+        }
+        result.events += count;
+    }
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // A new high-water mark of the allocator also covers the usage inside
+    // a call (a moving resize holds both blocks for a moment)
+    result.peakUsage = allocator->getPeakUsage() > peakBefore ? allocator->getPeakUsage() : peak;
+    result.liveBlocks = live.size();
+    for (unordered_map<uint64_t, void*>::iterator it = live.begin(); it != live.end(); ++it) {
+        allocator->deallocate(it->second);
+    }
+    return result;
+}
+
+
+// Return the number of events in the trace
+uint64_t TraceReplayer::getEventCount() const {
+    return m_eventCount;
+}
+
+// Return whether the trace is read through a memory map
+bool TraceReplayer::isMapped() const {
+    return m_map != nullptr;
+}
+
+
+// Removes the memory map, if any
+void TraceReplayer::unmap() {
+#if defined(__linux__)
+    if (m_map) {
+        munmap(m_map, m_mapSize);
+        m_map = nullptr;
+    }
+#endif
+}
+
+// Returns up to a window of events starting at 'index'
+// A mapped trace gives back the pages in front of the window first, so a
+// replay only keeps about one window resident; otherwise the window is read
+// into the buffer
+size_t TraceReplayer::fetch(uint64_t index, const TraceEvent*& events) {
+    if (index >= m_eventCount) {
+        return 0;
+    }
+    uint64_t remaining = m_eventCount - index;
+    size_t count = remaining < kWindowEvents ? (size_t)remaining : kWindowEvents;
+    size_t offset = sizeof(TraceFileHeader) + (size_t)index * sizeof(TraceEvent);
+
+#if defined(__linux__)
+    if (m_map) {
+        size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+        size_t consumed = offset & ~(pageSize - 1);
+        if (consumed > m_released) {
+            madvise(m_map + m_released, consumed - m_released, MADV_DONTNEED);
+            m_released = consumed;
+        }
+        events = (const TraceEvent*)(m_map + offset);
+        return count;
+    }
+#endif
+
+    m_buffer.resize(count);
+    m_file.clear();
+    m_file.seekg((streamoff)offset, ios::beg);
+    if (!m_file.read((char*)m_buffer.data(), count * sizeof(TraceEvent))) {
+        return 0; // The file shrank since it was opened
+    }
+    events = m_buffer.data();
+    return count;
+}
@@ -0,0 +1,60 @@
+#ifndef TRACE_REPLAYER_H
+#define TRACE_REPLAYER_H
+
+#include "MemoryManager.h"
+#include "TraceRecorder.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Feeds a trace written by TraceRecorder into any allocator.
+// The events are streamed: on Linux the file is memory-mapped and the pages
+// already replayed are dropped as the replay moves on, elsewhere it is read
+// in blocks - a trace larger than RAM replays in a bounded amount of memory.
+class TraceReplayer {
+
+    public:
+        // Outcome of one replay
+        struct Result {
+            uint64_t events;           // Events replayed
+            uint64_t allocations;      // Blocks requested (batches included)
+            uint64_t frees;            // deallocate calls made
+            uint64_t reallocations;    // reallocate calls made
+            size_t failedAllocations;  // Calls that returned nullptr
+            size_t peakUsage;          // Highest used memory during the replay
+            size_t liveBlocks;         // Blocks still allocated at the end
+            double seconds;            // Wall time of the replay
+        };
+
+        // Constructor - opens the trace and checks its header
+        // Throws invalid_argument if the file cannot be read or is not a
+        // complete trace
+        explicit TraceReplayer(const std::string& path);
+        ~TraceReplayer();                   // Unmaps or closes the file
+
+        // Replay every event on 'allocator'
+        // Blocks left allocated by the trace are freed after the timing
+        Result replay(MemoryManager* allocator);
+
+        uint64_t getEventCount() const;     // Events in the trace
+        bool isMapped() const;              // Whether the file is memory-mapped
+
+    private:
+        // Point 'events' at the events from 'index' on
+        // Returns how many are available there (0 at the end of the trace)
+        size_t fetch(uint64_t index, const TraceEvent*& events);
+        void unmap();                       // Remove the memory map, if any
+
+        static const size_t kWindowEvents = (64 << 20) / sizeof(TraceEvent); // 64 MiB
+
+        uint64_t m_eventCount;
+        char* m_map;                        // Whole file (nullptr = not mapped)
+        size_t m_mapSize;
+        size_t m_released;                  // Leading bytes of the map dropped
+        std::ifstream m_file;               // Used when the file is not mapped
+        std::vector<TraceEvent> m_buffer;   // Block read from m_file
+};
+
+
+#endif // TRACE_REPLAYER_H
@@ -0,0 +1,127 @@
+#include "Workload.h"
+#include <stdexcept>
+
+using namespace std;
+
+
+// Return the scenario names
+const vector<string>& Workload::getScenarios() {
+    static const char* const names[] = { "Random Allocations",
+                                         "Increasing Size Allocations",
+                                         "Decreasing Size Allocations",
+                                         "Fragmentation Test",
+                                         "Burst Allocations",
+                                         "Batch Burst Allocations",
+                                         "Mixed Overload" };
+    static const vector<string> scenarios(names, names + sizeof(names) / sizeof(names[0]));
+    return scenarios;
+}
+
+
+// Constructor - builds the operations of the scenario
+// Throws invalid_argument if the scenario is unknown
+Workload::Workload(const string& scenario, int iterations, mt19937& random)
+    : m_slots(0) {
+
+    if (scenario == "Random Allocations") {
+        // Random sizes, random frees
+        for (int i = 0; i < iterations; ++i) {
+            if (m_live.empty() || random() % 2 == 0) {
+                allocate(16 + random() % 128);
+            }
+            else {
+                release(random() % m_live.size());
+            }
+        }
+        releaseAll();
+    }
+    else if (scenario == "Increasing Size Allocations") {
+        for (size_t size = 4; size <= (size_t)iterations * 4; size += 4) {
+            allocate(size);
+        }
+        releaseAll();
+    }
+    else if (scenario == "Decreasing Size Allocations") {
+        for (size_t size = (size_t)iterations * 4; size >= 4; size -= 4) {
+            allocate(size);
+        }
+        releaseAll();
+    }
+    else if (scenario == "Fragmentation Test") {
+        // Every other block is freed, then the holes are filled again
+        for (int i = 0; i < iterations; ++i) {
+            allocate(64);
+        }
+        for (int i = 0; i < iterations; i += 2) {
+            release(i / 2);
+        }
+        for (int i = 1; i < iterations; i += 2) {
+            allocate(64);
+        }
+    }
+    else if (scenario == "Burst Allocations" || scenario == "Batch Burst Allocations") {
+        // Small blocks, all freed at the end - one call each, or one batch
+        bool batched = scenario == "Batch Burst Allocations";
+        for (int i = 0; i < iterations; ++i) {
+            allocate(32 + random() % 33, batched);
+        }
+        releaseAll(batched);
+    }
+    else if (scenario == "Mixed Overload") {
+        // Two sizes, the oldest block freed every fifth allocation
+        for (int i = 0; i < iterations; ++i) {
+            allocate(i % 2 == 0 ? 32 : 64);
+            if (i % 5 == 0) {
+                release(0);
+            }
+        }
+        releaseAll();
+    }
+    else {
+        throw invalid_argument("Unknown scenario: " + scenario);
+    }
+}
+
+
+// Return the operations in order
+const vector<Workload::Operation>& Workload::getOperations() const {
+    return m_operations;
+}
+
+// Return the number of slots the operations use
+size_t Workload::getSlotCount() const {
+    return m_slots;
+}
+
+// Return the index after the call that starts at 'index'
+size_t Workload::getCallEnd(size_t index) const {
+    const Operation& first = m_operations[index];
+    size_t end = index + 1;
+    while (first.batched && end < m_operations.size() && m_operations[end].batched &&
+        (m_operations[end].size == 0) == (first.size == 0)) {
+        end++;
+    }
+    return end;
+}
+
+
+// Add an allocation into a new slot
+void Workload::allocate(size_t size, bool batched) {
+    Operation op = { size, m_slots++, batched };
+    m_operations.push_back(op);
+    m_live.push_back(op.slot);
+}
+
+// Add a free of the live block at 'index' (0 = oldest)
+void Workload::release(size_t index, bool batched) {
+    Operation op = { 0, m_live[index], batched };
+    m_operations.push_back(op);
+    m_live.erase(m_live.begin() + index);
+}
+
+// Add a free of every live block, oldest first
+void Workload::releaseAll(bool batched) {
+    while (!m_live.empty()) {
+        release(0, batched);
+    }
+}
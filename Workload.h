@@ -0,0 +1,53 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+// The allocation scenarios shared by MemorySimulator and Benchmark.
+// A scenario is turned into a fixed list of operations before anything
+// runs, so every allocator gets the same requests and the random generator
+// stays out of the measurement. Blocks are kept in numbered slots; a free
+// of a slot whose allocation failed is skipped by the runner.
+class Workload {
+
+    public:
+        // One step: allocate 'size' bytes into 'slot', or free the block
+        // held by 'slot' when size is 0
+        // Batched steps next to each other, of the same kind, are made as
+        // one allocateBatch or deallocateBatch call
+        struct Operation {
+            size_t size;
+            size_t slot;
+            bool batched;
+        };
+
+        // Build the operations of 'scenario' with 'iterations' steps, drawing
+        // from 'random'
+        // Throws invalid_argument if the scenario is unknown
+        Workload(const std::string& scenario, int iterations, std::mt19937& random);
+
+        // Names of the scenarios
+        static const std::vector<std::string>& getScenarios();
+
+        const std::vector<Operation>& getOperations() const;
+        size_t getSlotCount() const;          // Slots used by the operations
+
+        // End of the call that starts at operation 'index': past its batch,
+        // or index + 1 for a single call
+        size_t getCallEnd(size_t index) const;
+
+    private:
+        void allocate(size_t size, bool batched = false); // Into a new slot
+        void release(size_t index, bool batched = false); // Live block 'index', oldest first
+        void releaseAll(bool batched = false);
+
+        std::vector<Operation> m_operations;
+        std::deque<size_t> m_live;            // Slots holding a block, oldest first
+        size_t m_slots;
+};
+
+
+#endif // WORKLOAD_H
@@ -1,25 +1,34 @@
 #ifndef WORST_FIT_ALLOCATOR_H
 #define WORST_FIT_ALLOCATOR_H
 
-#include "MemoryManager.h"
+#include "FitPolicy.h"
 
-class WorstFitAllocator : public MemoryManager {
+template <class Header>
+class BasicWorstFitAllocator : public BasicMemoryManager<Header> {
+
+    protected:
+        typedef BasicMemoryManager<Header> Base;
 
     public:
         // Constructor - initialize memory pool with given size
-        WorstFitAllocator(int poolSize);
+        BasicWorstFitAllocator(size_t poolSize,
+            const BackingStore& backing = BackingStore());
 
         // Allocate memory block using worst-fit algorithm
-        void* allocate(int size);
+        // (the WorstFit policy, through the virtual interface)
+        void* allocate(size_t size);
+        using Base::allocate;          // Aligned overload
 
         // Return the name of the allocation algorithm
         const char* getAlgorithmName() const;
-
-    private:
-        // Find the worst-fitting free block (largest block that fits)
-        Block* findWorstFit(int size);
 };
 
+// Allocator with the default 16-byte block header
+typedef BasicWorstFitAllocator<Block> WorstFitAllocator;
+
+// Allocator with the 8-byte block header (pools under 4 GiB)
+typedef BasicWorstFitAllocator<CompactBlock> CompactWorstFitAllocator;
+
 
 
 #endif // WORST_FIT_ALLOCATOR_H